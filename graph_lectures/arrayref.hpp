@@ -0,0 +1,51 @@
+////////////////////////////////////////////////////////////////////////////////
+// arrayref.hpp
+// Non-owning view of a contiguous array
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __ARRAYREF_HPP__
+#define __ARRAYREF_HPP__
+
+#include <vector>
+#include <cstddef>
+
+namespace MyCoolGraphLibrary {
+
+  namespace detail {
+
+    /**
+      @brief ArrayRef is a read-only view of n consecutive objects of type T.
+             It refers either to the buffer of a std::vector or to memory
+             owned by someone else (e.g. a memory-mapped file).
+    */
+    template<typename T>
+    class ArrayRef
+    {
+    public:
+      typedef const T*  const_iterator;
+      typedef const T*  iterator;
+      typedef T         value_type;
+
+      ArrayRef() : m_data(0), m_size(0) {}
+      ArrayRef(const T* d, std::size_t n) : m_data(d), m_size(n) {}
+      ArrayRef(const std::vector<T>& v) : m_data(v.data()), m_size(v.size()) {}
+
+      const T*    begin() const { return m_data; }
+      const T*    end()   const { return m_data + m_size; }
+      const T*    data()  const { return m_data; }
+      std::size_t size()  const { return m_size; }
+      bool        empty() const { return m_size == 0; }
+      const T& operator[](std::size_t i) const { return m_data[i]; }
+      const T& back() const { return m_data[m_size-1]; }
+
+    private:
+      const T*    m_data;
+      std::size_t m_size;
+    }; // ArrayRef
+
+  } // namespace detail
+
+} // namespace MyCoolGraphLibrary
+
+#endif
@@ -10,14 +10,22 @@
 #include <map>
 #include <set>
 #include <queue>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
 
 #include "labeledgraph.hpp"
+#include "compressedgraph.hpp"
+#include "traversalworkspace.hpp"
 
 namespace MyCoolGraphLibrary {
   
   // Forward declaration of embedded class
   namespace detail {
-    template<typename GRAPHEDGE> class GraphBFSSearch;
+    template<typename GRAPH, bool DENSE = is_dense_graph<GRAPH>::value> 
+    class GraphBFSSearch;
   }
   
   /**
@@ -26,38 +34,72 @@ namespace MyCoolGraphLibrary {
     @param start the start node of the graph
     @param the visitor object
   */  
-  template<typename GRAPHEDGE, typename VISITOR>
-  void breadth_first_search(const LabeledDirectedGraph<GRAPHEDGE>& g, 
-                            const typename GRAPHEDGE::Node& start, 
+  template<typename GRAPH, typename VISITOR>
+  void breadth_first_search(const GRAPH& g, 
+                            const typename GRAPH::Node& start, 
                             VISITOR& visitor)
   {
     // Instantiate the algorithm with the given graph
-    detail::GraphBFSSearch<GRAPHEDGE> bfs_algorithm(g);
+    detail::GraphBFSSearch<GRAPH> bfs_algorithm(g);
     // Start the search at the node
     bfs_algorithm.bfs(start,visitor);
   }
 
+  /**
+    @brief Same as above for dense graphs, but the search state is kept in
+           a workspace which is reused by later searches (no allocation,
+           no O(V) initialisation per search)
+  */
+  template<typename GRAPH, typename VISITOR>
+  void breadth_first_search(const GRAPH& g,
+                            const typename GRAPH::Node& start,
+                            VISITOR& visitor,
+                            TraversalWorkspace<GRAPH>& workspace)
+  {
+    detail::GraphBFSSearch<GRAPH> bfs_algorithm(g,workspace);
+    bfs_algorithm.bfs(start,visitor);
+  }
+
+  /**
+    @brief Same as the first version for generic graphs, but the queue and
+           the seen set are allocated from the memory resource r (e.g. a
+           std::pmr::monotonic_buffer_resource). Dense graphs keep their
+           state in a TraversalWorkspace instead.
+  */
+  template<typename GRAPH, typename VISITOR>
+  typename std::enable_if<!is_dense_graph<GRAPH>::value>::type
+  breadth_first_search(const GRAPH& g,
+                       const typename GRAPH::Node& start,
+                       VISITOR& visitor,
+                       std::pmr::memory_resource* r)
+  {
+    detail::GraphBFSSearch<GRAPH> bfs_algorithm(g,r);
+    bfs_algorithm.bfs(start,visitor);
+  }
+
 
   // We define a separate sub-namespace for the private definitions
   
   namespace detail {
   /**
     @brief Breadth-first search class for graphs.
-           The template parameter is the type of the graph edge.
+           The template parameter is the type of the graph.
   */
-  template<typename GRAPHEDGE>
+  template<typename GRAPH, bool DENSE>
   class GraphBFSSearch
   {
   public:
-    typedef typename GRAPHEDGE::Node  Node;
+    typedef typename GRAPH::Node  Node;
   
   public:
     /** 
       @brief Constructor
       @param g the graph
+      @param r the memory resource for the search state
     */
-    GraphBFSSearch(const LabeledDirectedGraph<GRAPHEDGE>& g) 
-    : the_graph(g) {}
+    GraphBFSSearch(const GRAPH& g,
+                   std::pmr::memory_resource* r = std::pmr::get_default_resource())
+    : the_graph(g), scratch(r) {}
     
     /** 
       @brief Start the breadth-first search at a given node and call 
@@ -68,24 +110,26 @@ namespace MyCoolGraphLibrary {
     void bfs(const Node& start, VISITOR& visitor)
     {
       // For bfs, we maintain a queue (agenda, todo list) of nodes yet
-      // to be processed and a set containing those nodes already seen
+      // to be processed and a set containing those nodes already seen.
+      // A node is marked as seen when it enters the queue, so that it
+      // is queued (and visited) only once, even if many edges lead to it.
       // Initialise queue with start node
-      std::queue<Node> unprocessed;
-      std::set<Node> processed;
+      std::queue<Node,std::pmr::deque<Node> > unprocessed{std::pmr::deque<Node>(scratch)};
+      std::pmr::set<Node> seen(scratch);
       unprocessed.push(start);
+      seen.insert(start);
       
       while (!unprocessed.empty()) {
-        // Pop node from queue and add it to processed set
+        // Pop node from queue
         Node n = unprocessed.front();
         unprocessed.pop();
-        processed.insert(n);
         // Call visitor
         visitor(n);
         // Get neighbours of n ('auto&' to be sure to use the reference)
-        auto& neighbours = the_graph[n];
+        const auto& neighbours = the_graph[n];
         for (auto e = neighbours.begin(); e != neighbours.end(); ++e) {
-          if (processed.find(e->target()) == processed.end()) {
-            // neighbour is yet unprocessed
+          if (seen.insert(e->target()).second) {
+            // neighbour has not been seen before
             unprocessed.push(e->target());
           }
         } // for e        
@@ -93,9 +137,74 @@ namespace MyCoolGraphLibrary {
     }
 
   private: // Member variables
-    const LabeledDirectedGraph<GRAPHEDGE>& the_graph;
+    const GRAPH& the_graph;
+    std::pmr::memory_resource* scratch;   ///< Memory for the search state
   }; // GraphBFSSearch
 
+  /**
+    @brief Breadth-first search for dense graphs (e.g. CompressedGraph).
+           The queue and the seen flags live in a TraversalWorkspace, either
+           the caller's or one of its own. Nodes are marked when they are
+           enqueued, so each node is visited exactly once.
+  */
+  template<typename GRAPH>
+  class GraphBFSSearch<GRAPH,true>
+  {
+  public:
+    typedef typename GRAPH::Node    Node;
+    typedef typename GRAPH::NodeId  NodeId;
+    typedef typename GRAPH::EdgeIndex EdgeIndex;
+
+  public:
+    /** 
+      @brief Constructor
+      @param g the graph
+    */
+    GraphBFSSearch(const GRAPH& g) 
+    : the_graph(g), own_workspace(new TraversalWorkspace<GRAPH>(g)),
+      workspace(*own_workspace) {}
+
+    /// Constructor using the workspace ws of graph g
+    GraphBFSSearch(const GRAPH& g, TraversalWorkspace<GRAPH>& ws)
+    : the_graph(g), workspace(ws) {}
+
+    /** 
+      @brief Start the breadth-first search at a given node and call 
+             the visitor for each node in BFS discovery order.
+    */
+    template<typename VISITOR>
+    void bfs(const Node& start, VISITOR& visitor)
+    {
+      NodeId s = the_graph.id(start);
+      if (s == GRAPH::NoNode()) {
+        // Unknown node: like in the generic version, it is visited alone
+        visitor(start);
+        return;
+      }
+      // The queue is a vector with a read position, since each node
+      // enters it at most once
+      workspace.start();
+      std::vector<NodeId>& queue = workspace.queue();
+      queue.push_back(s);
+      workspace.visit(s);
+
+      for (std::size_t head = 0; head < queue.size(); ++head) {
+        NodeId u = queue[head];
+        visitor(the_graph.node(u));
+        for (EdgeIndex e = the_graph.first_edge(u); e != the_graph.last_edge(u); ++e) {
+          NodeId v = the_graph.target(e);
+          if (workspace.visit(v))
+            queue.push_back(v);
+        } // for e
+      } // for head
+    }
+
+  private: // Member variables
+    const GRAPH& the_graph;
+    std::unique_ptr< TraversalWorkspace<GRAPH> > own_workspace;
+    TraversalWorkspace<GRAPH>& workspace;
+  }; // GraphBFSSearch<GRAPH,true>
+
   } // namespace detail
 } // namespace MyCoolGraphLibrary
 
@@ -0,0 +1,266 @@
+////////////////////////////////////////////////////////////////////////////////
+// binarygraph.hpp
+// Compact binary edge list format for CompressedGraph
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BINARYGRAPH_HPP__
+#define __BINARYGRAPH_HPP__
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+#include <cstring>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "compressedgraph.hpp"
+#include "outputbuffer.hpp"
+#include "filemapping.hpp"
+#include "graphfile.hpp"
+
+namespace MyCoolGraphLibrary {
+
+  /*
+    Binary edge list format, version 1. All numbers are little-endian.
+    Unlike the graph file (graphfile.hpp) it is meant for exchange, not
+    for mapping: it is read sequentially and is much smaller.
+
+    Header (48 bytes):
+      char   magic[8]        "MCEDGES\0"
+      uint32 version         1
+      uint32 flags           bit 0: the graph has edge weights
+      uint64 no_of_nodes     n
+      uint64 no_of_edges     m
+      uint32 node_size       sizeof(Node)
+      uint32 label_size      sizeof(Label)
+      uint32 weight_size     sizeof(Weight) (0 if not weighted)
+      uint32 reserved        0
+
+    Body:
+      Node[n]                the nodes in id order (raw bytes)
+      for each node u:
+        varint out_degree
+        for each leaving edge: varint zigzag(target - previous target),
+        where the first previous target is u, then the label and the
+        weight as raw bytes
+
+    Varints store 7 bits per byte, lowest first; the high bit marks that
+    another byte follows. Neighbouring ids mostly differ by little, so a
+    target usually takes one or two bytes instead of four.
+  */
+
+  namespace detail {
+
+    const char          binary_graph_magic[8]    = { 'M','C','E','D','G','E','S','\0' };
+    const std::uint32_t binary_graph_version     = 1;
+    const std::uint32_t binary_graph_weighted    = 1;
+    const std::size_t   binary_graph_header_size = 48;
+
+    /// Appends x as a varint
+    inline void put_varint(OutputBuffer& out, std::uint64_t x)
+    {
+      char bytes[10];
+      std::size_t n = 0;
+      while (x >= 0x80) {
+        bytes[n++] = char((x & 0x7f) | 0x80);
+        x >>= 7;
+      }
+      bytes[n++] = char(x);
+      out.write(bytes,n);
+    }
+
+    /// Reads a varint from [p,end); throws at the end of the input
+    inline std::uint64_t get_varint(const unsigned char*& p, const unsigned char* end)
+    {
+      std::uint64_t x = 0;
+      for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (p == end)
+          throw std::runtime_error("binary graph is truncated");
+        unsigned char b = *p++;
+        x |= std::uint64_t(b & 0x7f) << shift;
+        if (!(b & 0x80)) return x;
+      }
+      throw std::runtime_error("binary graph has a malformed number");
+    }
+
+    inline std::uint64_t zigzag(std::int64_t d)
+    {
+      return (std::uint64_t(d) << 1) ^ std::uint64_t(d >> 63);
+    }
+
+    inline std::int64_t unzigzag(std::uint64_t z)
+    {
+      return std::int64_t(z >> 1) ^ -std::int64_t(z & 1);
+    }
+
+    /// Checks that nodes, labels and weights can be stored as raw bytes
+    template<typename GRAPHEDGE>
+    struct check_binary_graph_edge
+    {
+      typedef CompressedGraph<GRAPHEDGE> Graph;
+      static_assert(std::is_trivially_copyable<typename Graph::Node>::value &&
+                    std::is_trivially_copyable<typename Graph::Label>::value &&
+                    std::is_trivially_copyable<typename Graph::Weight>::value,
+                    "binary graphs store nodes, labels and weights as raw bytes");
+    };
+
+  } // namespace detail
+
+
+  /**
+    @brief Writes graph g in the binary edge list format (see above) to
+           out, e.g. an OutputBuffer on a file descriptor. Nodes, labels
+           and weights must be trivially copyable (e.g. integers or
+           StringDictionary handles).
+  */
+  template<typename GRAPHEDGE>
+  void write_binary_graph(OutputBuffer& out, const CompressedGraph<GRAPHEDGE>& g)
+  {
+    typedef CompressedGraph<GRAPHEDGE>  Graph;
+    typedef typename Graph::NodeId      NodeId;
+    typedef typename Graph::EdgeIndex   EdgeIndex;
+    detail::check_binary_graph_edge<GRAPHEDGE> check;
+    (void) check;
+    if (!detail::host_is_little_endian())
+      throw std::runtime_error("binary graphs can only be written on little-endian machines");
+
+    const bool weighted = edge_traits<GRAPHEDGE>::has_weight;
+    unsigned char header[detail::binary_graph_header_size];
+    std::memset(header,0,sizeof(header));
+    std::memcpy(header,detail::binary_graph_magic,8);
+    detail::put_u32(header+8,detail::binary_graph_version);
+    detail::put_u32(header+12,weighted ? detail::binary_graph_weighted : 0);
+    detail::put_u64(header+16,g.no_of_nodes());
+    detail::put_u64(header+24,g.no_of_edges());
+    detail::put_u32(header+32,sizeof(typename Graph::Node));
+    detail::put_u32(header+36,sizeof(typename Graph::Label));
+    detail::put_u32(header+40,weighted ? sizeof(typename Graph::Weight) : 0);
+    out.write(reinterpret_cast<const char*>(header),sizeof(header));
+    if (g.no_of_nodes() > 0)
+      out.write(reinterpret_cast<const char*>(g.nodes().data()),
+                g.no_of_nodes() * sizeof(typename Graph::Node));
+
+    for (NodeId u = 0; u < g.no_of_nodes(); ++u) {
+      detail::put_varint(out,g.out_degree(u));
+      std::int64_t previous = u;
+      for (EdgeIndex e = g.first_edge(u); e != g.last_edge(u); ++e) {
+        detail::put_varint(out,detail::zigzag(std::int64_t(g.target(e)) - previous));
+        previous = g.target(e);
+        typename Graph::Label l = g.label(e);
+        out.write(reinterpret_cast<const char*>(&l),sizeof(l));
+        if (weighted) {
+          typename Graph::Weight w = g.weight(e);
+          out.write(reinterpret_cast<const char*>(&w),sizeof(w));
+        }
+      }
+    }
+    out.flush();
+  }
+
+  /// Writes graph g in the binary edge list format to the file path
+  template<typename GRAPHEDGE>
+  void write_binary_graph(const std::string& path, const CompressedGraph<GRAPHEDGE>& g)
+  {
+    int fd = ::open(path.c_str(),O_WRONLY | O_CREAT | O_TRUNC,0644);
+    if (fd < 0)
+      throw std::runtime_error("cannot create " + path);
+    try {
+      OutputBuffer out(fd);
+      write_binary_graph(out,g);
+    }
+    catch (...) {
+      ::close(fd);
+      throw;
+    }
+    if (::close(fd) != 0)
+      throw std::runtime_error("error writing " + path);
+  }
+
+  /**
+    @brief Reads a graph in the binary edge list format from the file path;
+           throws std::runtime_error if it is not a valid binary graph of
+           the edge type.
+  */
+  template<typename GRAPHEDGE>
+  CompressedGraph<GRAPHEDGE> read_binary_graph(const std::string& path)
+  {
+    typedef CompressedGraph<GRAPHEDGE>  Graph;
+    typedef typename Graph::NodeId      NodeId;
+    typedef typename Graph::EdgeIndex   EdgeIndex;
+    typedef typename Graph::Node        Node;
+    typedef typename Graph::Label       Label;
+    typedef typename Graph::Weight      Weight;
+    detail::check_binary_graph_edge<GRAPHEDGE> check;
+    (void) check;
+    if (!detail::host_is_little_endian())
+      throw std::runtime_error("binary graphs can only be read on little-endian machines");
+
+    const bool weighted = edge_traits<GRAPHEDGE>::has_weight;
+    detail::FileMapping file(path);
+    const unsigned char* p = file.data();
+    const unsigned char* end = p + file.size();
+    if (file.size() < detail::binary_graph_header_size ||
+        std::memcmp(p,detail::binary_graph_magic,8) != 0)
+      throw std::runtime_error(path + " is not a binary graph");
+    if (detail::get_u32(p+8) != detail::binary_graph_version)
+      throw std::runtime_error(path + " has an unsupported version");
+    if (bool(detail::get_u32(p+12) & detail::binary_graph_weighted) != weighted ||
+        detail::get_u32(p+32) != sizeof(Node) || detail::get_u32(p+36) != sizeof(Label) ||
+        detail::get_u32(p+40) != (weighted ? sizeof(Weight) : 0))
+      throw std::runtime_error(path + " does not match the edge type");
+    const std::uint64_t n = detail::get_u64(p+16);
+    const std::uint64_t m = detail::get_u64(p+24);
+    p += detail::binary_graph_header_size;
+    // Every edge takes at least one byte, which bounds the allocations
+    if (n >= Graph::NoNode() || std::uint64_t(end - p) / sizeof(Node) < n ||
+        std::uint64_t(end - p) < m)
+      throw std::runtime_error(path + " is truncated or corrupt");
+
+    typename Graph::NodeVector nodes(n);
+    if (n > 0) std::memcpy(nodes.data(),p,n * sizeof(Node));
+    p += n * sizeof(Node);
+
+    std::vector<EdgeIndex> offsets(n+1,0);
+    std::vector<NodeId> targets(m);
+    std::vector<Label> labels(m);
+    std::vector<Weight> weights(weighted ? m : 0);
+    const std::size_t entry_size = sizeof(Label) + (weighted ? sizeof(Weight) : 0);
+    EdgeIndex e = 0;
+    for (NodeId u = 0; u < n; ++u) {
+      std::uint64_t degree = detail::get_varint(p,end);
+      if (degree > m - e)
+        throw std::runtime_error(path + " is truncated or corrupt");
+      std::int64_t previous = u;
+      for (std::uint64_t k = 0; k < degree; ++k, ++e) {
+        std::int64_t v = previous + detail::unzigzag(detail::get_varint(p,end));
+        if (v < 0 || std::uint64_t(v) >= n || std::size_t(end - p) < entry_size)
+          throw std::runtime_error(path + " is truncated or corrupt");
+        targets[e] = NodeId(v);
+        previous = v;
+        // Through a local since vector<bool> has no element addresses
+        Label l;
+        std::memcpy(&l,p,sizeof(Label));
+        labels[e] = l;
+        p += sizeof(Label);
+        if (weighted) {
+          Weight w;
+          std::memcpy(&w,p,sizeof(Weight));
+          weights[e] = w;
+          p += sizeof(Weight);
+        }
+      }
+      offsets[u+1] = e;
+    }
+    if (e != m)
+      throw std::runtime_error(path + " is truncated or corrupt");
+    return Graph(std::move(nodes),std::move(offsets),std::move(targets),
+                 std::move(labels),std::move(weights));
+  }
+
+} // namespace MyCoolGraphLibrary
+
+#endif
@@ -0,0 +1,67 @@
+////////////////////////////////////////////////////////////////////////////////
+// bitmap.hpp
+// Fixed-size bit set over dense node ids
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BITMAP_HPP__
+#define __BITMAP_HPP__
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+namespace MyCoolGraphLibrary {
+
+  namespace detail {
+
+    /**
+      @brief Bitmap holds one bit per node id in 64 bit words.
+             Unlike std::vector<bool> it gives access to the words, so
+             whole blocks of nodes can be skipped or cleared at once.
+    */
+    class Bitmap
+    {
+    public:
+      typedef std::uint64_t Word;
+
+      explicit Bitmap(std::size_t n = 0) : m_size(n), m_words((n + 63) / 64,0) {}
+
+      void set(std::size_t i)         { m_words[i >> 6] |= Word(1) << (i & 63); }
+      void reset(std::size_t i)       { m_words[i >> 6] &= ~(Word(1) << (i & 63)); }
+      bool test(std::size_t i) const  { return (m_words[i >> 6] >> (i & 63)) & 1; }
+
+      /// Clears all bits
+      void clear() { std::fill(m_words.begin(),m_words.end(),Word(0)); }
+
+      /// Returns the number of set bits
+      std::size_t count() const
+      {
+        std::size_t c = 0;
+        for (auto w = m_words.begin(); w != m_words.end(); ++w) {
+          c += __builtin_popcountll(*w);
+        }
+        return c;
+      }
+
+      std::size_t size() const { return m_size; }
+      std::size_t no_of_words() const { return m_words.size(); }
+      Word  word(std::size_t w) const { return m_words[w]; }
+      Word& word(std::size_t w)       { return m_words[w]; }
+
+      void swap(Bitmap& b)
+      {
+        std::swap(m_size,b.m_size);
+        m_words.swap(b.m_words);
+      }
+
+    private:
+      std::size_t       m_size;   ///< Number of bits
+      std::vector<Word> m_words;  ///< The bits
+    }; // Bitmap
+
+  } // namespace detail
+
+} // namespace MyCoolGraphLibrary
+
+#endif
@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////
+// ch-bench.cpp
+// Compares contraction hierarchy queries with distance_search
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+// Usage: ch-bench [grid side length] [number of queries]
+// Build: g++ -std=c++17 -O2 ch-bench.cpp -o ch-bench
+
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <iostream>
+
+#include "wgraphedge.hpp"
+#include "labeledgraph.hpp"
+#include "compressedgraph.hpp"
+#include "dijkstra.hpp"
+#include "contractionhierarchy.hpp"
+
+using MyCoolGraphLibrary::WeightedGraphEdge;
+using MyCoolGraphLibrary::LabeledDirectedGraph;
+using MyCoolGraphLibrary::CompressedGraph;
+using MyCoolGraphLibrary::ContractionHierarchy;
+using MyCoolGraphLibrary::ContractionHierarchyQuery;
+
+typedef WeightedGraphEdge<unsigned,unsigned> Edge;
+typedef CompressedGraph<Edge> Graph;
+typedef std::chrono::steady_clock Clock;
+
+/// Seconds since t
+double seconds_since(Clock::time_point t)
+{
+  return std::chrono::duration<double>(Clock::now() - t).count();
+}
+
+/// Visitor which counts the settled nodes (distance_search has no early
+/// exit, so it settles all reachable nodes)
+struct SettledCounter
+{
+  SettledCounter() : settled(0) {}
+  void operator()(unsigned) { ++settled; }
+  std::size_t settled;
+};
+
+int main(int argc, char* argv[])
+{
+  const unsigned side = (argc > 1) ? std::atoi(argv[1]) : 300;
+  const unsigned queries = (argc > 2) ? std::atoi(argv[2]) : 1000;
+
+  // A grid with random weights in both directions, like a small road map
+  std::mt19937 rng(42);
+  LabeledDirectedGraph<Edge> g;
+  for (unsigned y = 0; y < side; ++y) {
+    for (unsigned x = 0; x < side; ++x) {
+      unsigned u = y * side + x;
+      if (x + 1 < side) {
+        g.add(Edge(u,0,u+1,1 + rng() % 100));
+        g.add(Edge(u+1,0,u,1 + rng() % 100));
+      }
+      if (y + 1 < side) {
+        g.add(Edge(u,0,u+side,1 + rng() % 100));
+        g.add(Edge(u+side,0,u,1 + rng() % 100));
+      }
+    }
+  }
+  Graph graph(g);
+  std::cout << "Graph: " << graph.no_of_nodes() << " nodes, "
+            << graph.no_of_edges() << " edges" << std::endl;
+
+  Clock::time_point start = Clock::now();
+  ContractionHierarchy<Graph> ch = MyCoolGraphLibrary::build_contraction_hierarchy(graph);
+  std::cout << "Preprocessing: " << seconds_since(start) << " s, "
+            << ch.upward().no_of_edges() + ch.downward().no_of_edges()
+            << " hierarchy edges" << std::endl;
+
+  std::vector<unsigned> sources(queries), targets(queries);
+  for (unsigned i = 0; i < queries; ++i) {
+    sources[i] = rng() % graph.no_of_nodes();
+    targets[i] = rng() % graph.no_of_nodes();
+  }
+
+  // Contraction hierarchy queries with path unpacking
+  ContractionHierarchyQuery<Graph> query(ch);
+  std::vector<unsigned long> ch_distance(queries);
+  std::size_t ch_settled = 0, path_nodes = 0;
+  start = Clock::now();
+  for (unsigned i = 0; i < queries; ++i) {
+    auto result = query.run(sources[i],targets[i]);
+    ch_distance[i] = result.distance;
+    ch_settled += result.settled;
+    path_nodes += result.path.size();
+  }
+  double ch_time = seconds_since(start);
+
+  // Dijkstra: one full distance_search per query, reusing a workspace
+  MyCoolGraphLibrary::TraversalWorkspace<Graph> workspace(graph);
+  std::size_t dijkstra_settled = 0;
+  unsigned mismatches = 0;
+  start = Clock::now();
+  for (unsigned i = 0; i < queries; ++i) {
+    SettledCounter counter;
+    MyCoolGraphLibrary::distance_search(graph,graph.node(sources[i]),counter,workspace);
+    dijkstra_settled += counter.settled;
+    if (workspace.distance(targets[i]) != ch_distance[i]) ++mismatches;
+  }
+  double dijkstra_time = seconds_since(start);
+
+  std::cout << "Contraction hierarchy: " << 1e6 * ch_time / queries << " us/query, "
+            << ch_settled / queries << " settled, "
+            << path_nodes / queries << " path nodes" << std::endl;
+  std::cout << "distance_search:       " << 1e6 * dijkstra_time / queries << " us/query, "
+            << dijkstra_settled / queries << " settled" << std::endl;
+  std::cout << "Speedup: " << dijkstra_time / ch_time
+            << ", mismatches: " << mismatches << std::endl;
+  return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,324 @@
+////////////////////////////////////////////////////////////////////////////////
+// compressedgraph.hpp
+// Frozen graph snapshot in compressed sparse row (CSR) format
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __COMPRESSEDGRAPH_HPP__
+#define __COMPRESSEDGRAPH_HPP__
+
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <cstdint>
+#include <utility>
+#include <memory>
+
+#include "graphtraits.hpp"
+#include "arrayref.hpp"
+#include "labeledgraph.hpp"
+
+namespace MyCoolGraphLibrary {
+
+/**
+  @brief CompressedGraph is a read-only snapshot of a labeled directed graph.
+         Nodes are numbered 0..n-1 in the order of the source graph's node
+         set. The leaving edges of node u are stored at the positions
+         offsets[u]..offsets[u+1]-1 of the target, label and weight arrays.
+         So all edges lie in a few contiguous arrays and visiting the
+         neighbours of a node is a linear scan.
+         The arrays are either owned by the graph or live in external
+         memory, e.g. a memory-mapped graph file (see graphfile.hpp).
+*/
+template<typename GRAPHEDGE>
+class CompressedGraph
+{
+public: // Types
+  typedef GRAPHEDGE                                   GraphEdge;
+  typedef typename GraphEdge::Node                    Node;
+  typedef typename GraphEdge::Label                   Label;
+  typedef typename edge_traits<GraphEdge>::Weight     Weight;
+  typedef std::uint32_t                               NodeId;
+  typedef std::uint64_t                               EdgeIndex;
+  typedef std::vector<Node>                           NodeVector;
+  typedef detail::ArrayRef<Node>                      NodeRange;
+
+  /// Light-weight view of an edge, compatible with the GRAPHEDGE interface
+  class EdgeRef
+  {
+  public:
+    EdgeRef(const CompressedGraph* g, NodeId s, EdgeIndex e)
+    : graph(g), src(s), idx(e) {}
+
+    const Node&  source() const { return graph->node(src); }
+    const Node&  target() const { return graph->node(graph->target(idx)); }
+    const Label& label()  const { return graph->label(idx); }
+    Weight       weight() const { return graph->weight(idx); }
+
+    NodeId    source_id() const { return src; }
+    NodeId    target_id() const { return graph->target(idx); }
+    EdgeIndex index()     const { return idx; }
+
+  private:
+    friend class CompressedGraph;
+    const CompressedGraph* graph;
+    NodeId src;
+    EdgeIndex idx;
+  }; // EdgeRef
+
+  /// Iterator over the leaving edges of a node
+  class EdgeIterator
+  {
+  public:
+    EdgeIterator(const CompressedGraph* g, NodeId s, EdgeIndex e) : cur(g,s,e) {}
+
+    const EdgeRef& operator*()  const { return cur; }
+    const EdgeRef* operator->() const { return &cur; }
+    EdgeIterator& operator++() { ++cur.idx; return *this; }
+    bool operator==(const EdgeIterator& it) const { return cur.idx == it.cur.idx; }
+    bool operator!=(const EdgeIterator& it) const { return cur.idx != it.cur.idx; }
+
+  private:
+    EdgeRef cur;
+  }; // EdgeIterator
+
+  /// The leaving edges of a node, returned by operator[]
+  class EdgeRange
+  {
+  public:
+    EdgeRange(const CompressedGraph* g, NodeId s, EdgeIndex b, EdgeIndex e)
+    : graph(g), src(s), first(b), last(e) {}
+
+    EdgeIterator begin() const { return EdgeIterator(graph,src,first); }
+    EdgeIterator end()   const { return EdgeIterator(graph,src,last); }
+    std::size_t  size()  const { return last - first; }
+    bool         empty() const { return first == last; }
+
+  private:
+    const CompressedGraph* graph;
+    NodeId src;
+    EdgeIndex first, last;
+  }; // EdgeRange
+
+public: // Static functions
+  inline static NodeId NoNode() { return NodeId(-1); }
+
+public:
+  /// Constructs an empty graph
+  CompressedGraph() : m_offset_data(1,0) { attach(); }
+
+  /// Freezes a graph. GRAPH must provide nodes() and operator[] like
+  /// LabeledDirectedGraph does.
+  template<typename GRAPH>
+  explicit CompressedGraph(const GRAPH& g)
+  {
+    m_node_data.assign(g.nodes().begin(),g.nodes().end());
+    m_nodes = NodeRange(m_node_data);
+    // Count the edges first, so that each array is allocated exactly once
+    m_offset_data.reserve(m_node_data.size()+1);
+    m_offset_data.push_back(0);
+    for (auto n = m_node_data.begin(); n != m_node_data.end(); ++n) {
+      m_offset_data.push_back(m_offset_data.back() + g[*n].size());
+    }
+    m_target_data.reserve(m_offset_data.back());
+    m_label_data.reserve(m_offset_data.back());
+    if (edge_traits<GraphEdge>::has_weight)
+      m_weight_data.reserve(m_offset_data.back());
+
+    for (auto n = m_node_data.begin(); n != m_node_data.end(); ++n) {
+      const auto& neighbours = g[*n];
+      for (auto e = neighbours.begin(); e != neighbours.end(); ++e) {
+        m_target_data.push_back(id(e->target()));
+        m_label_data.push_back(e->label());
+        if (edge_traits<GraphEdge>::has_weight)
+          m_weight_data.push_back(edge_weight(*e));
+      }
+    }
+    attach();
+  }
+
+  /**
+    @brief Constructs the graph directly from its arrays (see the class
+           comment). nodes must be sorted, offsets has nodes.size()+1
+           entries, weights is empty for unweighted edge types.
+  */
+  CompressedGraph(NodeVector&& nodes, std::vector<EdgeIndex>&& offsets,
+                  std::vector<NodeId>&& targets, std::vector<Label>&& labels,
+                  std::vector<Weight>&& weights)
+  : m_node_data(std::move(nodes)), m_offset_data(std::move(offsets)),
+    m_target_data(std::move(targets)), m_label_data(std::move(labels)),
+    m_weight_data(std::move(weights))
+  {
+    attach();
+  }
+
+  /**
+    @brief Constructs a graph whose arrays live in external memory.
+           Nothing is copied; owner keeps the memory alive as long as the
+           graph (or a copy of it) exists.
+  */
+  CompressedGraph(NodeRange nodes, detail::ArrayRef<EdgeIndex> offsets,
+                  detail::ArrayRef<NodeId> targets, detail::ArrayRef<Label> labels,
+                  detail::ArrayRef<Weight> weights, std::shared_ptr<const void> owner)
+  : m_nodes(nodes), m_offsets(offsets), m_targets(targets), m_labels(labels),
+    m_weights(weights), m_owner(owner)
+  {}
+
+  /// Copy constructor
+  CompressedGraph(const CompressedGraph& g)
+  : m_node_data(g.m_node_data), m_offset_data(g.m_offset_data),
+    m_target_data(g.m_target_data), m_label_data(g.m_label_data),
+    m_weight_data(g.m_weight_data), m_nodes(g.m_nodes), m_offsets(g.m_offsets), 
+    m_targets(g.m_targets), m_labels(g.m_labels), m_weights(g.m_weights),
+    m_owner(g.m_owner)
+  {
+    if (!m_owner) attach();
+  }
+
+  /// Move constructor
+  CompressedGraph(CompressedGraph&& g)
+  : CompressedGraph()
+  {
+    swap(g);
+  }
+
+  /// Assignment
+  CompressedGraph& operator=(CompressedGraph g)
+  {
+    swap(g);
+    return *this;
+  }
+
+  /// Exchanges the contents of two graphs
+  void swap(CompressedGraph& g)
+  {
+    // Swapping vectors keeps their buffers, so the views stay valid
+    m_node_data.swap(g.m_node_data);
+    m_offset_data.swap(g.m_offset_data);
+    m_target_data.swap(g.m_target_data);
+    m_label_data.swap(g.m_label_data);
+    m_weight_data.swap(g.m_weight_data);
+    std::swap(m_nodes,g.m_nodes);
+    std::swap(m_offsets,g.m_offsets);
+    std::swap(m_targets,g.m_targets);
+    std::swap(m_labels,g.m_labels);
+    std::swap(m_weights,g.m_weights);
+    m_owner.swap(g.m_owner);
+  }
+
+  /// Returns true iff the arrays live in external memory
+  bool is_external() const { return bool(m_owner); }
+
+  /// Returns the number of nodes
+  NodeId no_of_nodes() const { return m_nodes.size(); }
+
+  /// Returns the number of edges
+  EdgeIndex no_of_edges() const { return m_targets.size(); }
+
+  /// Returns the dense id of node n or NoNode() if n is not in the graph
+  NodeId id(const Node& n) const
+  {
+    // The node vector is sorted, so a binary search does the job
+    auto it = std::lower_bound(m_nodes.begin(),m_nodes.end(),n);
+    return (it != m_nodes.end() && !(n < *it)) ? NodeId(it - m_nodes.begin()) : NoNode();
+  }
+
+  /// Returns the node with id u
+  const Node& node(NodeId u) const { return m_nodes[u]; }
+
+  /// Accessor for the nodes (sorted, index = node id)
+  const NodeRange& nodes() const { return m_nodes; }
+
+  /// Index of the first leaving edge of u
+  EdgeIndex first_edge(NodeId u) const { return m_offsets[u]; }
+  /// Index one past the last leaving edge of u
+  EdgeIndex last_edge(NodeId u)  const { return m_offsets[u+1]; }
+  /// Number of leaving edges of u
+  std::size_t out_degree(NodeId u) const { return m_offsets[u+1] - m_offsets[u]; }
+
+  /// Target node id of edge e
+  NodeId target(EdgeIndex e) const { return m_targets[e]; }
+  /// Label of edge e
+  const Label& label(EdgeIndex e) const { return m_labels[e]; }
+  /// Weight of edge e (1 for unweighted edge types)
+  Weight weight(EdgeIndex e) const
+  {
+    return edge_traits<GraphEdge>::has_weight ? m_weights[e] : Weight(1);
+  }
+
+  /// Access to the leaving edges of the node with id u
+  EdgeRange edges(NodeId u) const
+  {
+    return EdgeRange(this,u,m_offsets[u],m_offsets[u+1]);
+  }
+
+  /// Access to the leaving edges of node n (empty for unknown nodes)
+  EdgeRange operator[](const Node& n) const
+  {
+    NodeId u = id(n);
+    return (u != NoNode()) ? edges(u) : EdgeRange(this,u,0,0);
+  }
+
+  /// Stream output
+  friend std::ostream& operator<<(std::ostream& o, const CompressedGraph& g)
+  {
+    o << "graph({" << std::endl;
+    for (NodeId u = 0; u < g.no_of_nodes(); ++u) {
+      for (EdgeIndex e = g.first_edge(u); e != g.last_edge(u); ++e) {
+        o << g.node(u) << " -- " << g.label(e) <<  " --> " << g.node(g.target(e)) << "\n";
+      }
+    }
+    o << "})" << std::endl;
+    return o;
+  }
+
+  /// Raw arrays, e.g. for writing the graph to a file
+  const detail::ArrayRef<EdgeIndex>& offset_array() const { return m_offsets; }
+  const detail::ArrayRef<NodeId>&    target_array() const { return m_targets; }
+  const detail::ArrayRef<Label>&     label_array()  const { return m_labels; }
+  const detail::ArrayRef<Weight>&    weight_array() const { return m_weights; }
+
+private: // Functions
+  /// Points the views to the owned arrays
+  void attach()
+  {
+    m_nodes   = NodeRange(m_node_data);
+    m_offsets = detail::ArrayRef<EdgeIndex>(m_offset_data);
+    m_targets = detail::ArrayRef<NodeId>(m_target_data);
+    m_labels  = detail::ArrayRef<Label>(m_label_data);
+    m_weights = detail::ArrayRef<Weight>(m_weight_data);
+  }
+
+private:
+  // Owned arrays (empty if the graph lives in external memory)
+  NodeVector             m_node_data;
+  std::vector<EdgeIndex> m_offset_data;
+  std::vector<NodeId>    m_target_data;
+  std::vector<Label>     m_label_data;
+  std::vector<Weight>    m_weight_data;
+
+  // Views used by all accessors
+  NodeRange                   m_nodes;   ///< Maps node ids to nodes (sorted)
+  detail::ArrayRef<EdgeIndex> m_offsets; ///< Edges of u are at [offsets[u],offsets[u+1])
+  detail::ArrayRef<NodeId>    m_targets; ///< Target node id of each edge
+  detail::ArrayRef<Label>     m_labels;  ///< Label of each edge
+  detail::ArrayRef<Weight>    m_weights; ///< Weight of each edge (empty if unweighted)
+  std::shared_ptr<const void> m_owner;   ///< Keeps external memory alive
+}; // CompressedGraph
+
+template<typename GRAPHEDGE>
+struct is_dense_graph< CompressedGraph<GRAPHEDGE> >
+{
+  static const bool value = true;
+};
+
+/// Returns a frozen CSR snapshot of graph g
+template<typename GRAPHEDGE, typename STORAGE>
+CompressedGraph<GRAPHEDGE> freeze(const LabeledDirectedGraph<GRAPHEDGE,STORAGE>& g)
+{
+  return CompressedGraph<GRAPHEDGE>(g);
+}
+
+} // namespace MyCoolGraphLibrary
+
+#endif
@@ -0,0 +1,791 @@
+////////////////////////////////////////////////////////////////////////////////
+// contractionhierarchy.hpp
+// Contraction hierarchies for fast repeated shortest-path queries
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __CONTRACTIONHIERARCHY_HPP__
+#define __CONTRACTIONHIERARCHY_HPP__
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <limits>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+#include "wgraphedge.hpp"
+#include "compressedgraph.hpp"
+#include "traversalworkspace.hpp"
+#include "pointtopoint.hpp"
+#include "graphfile.hpp"
+#include "dheap.hpp"
+
+namespace MyCoolGraphLibrary {
+
+  /**
+    @brief ContractionHierarchy is the result of preprocessing a dense graph
+           for shortest-path queries (Geisberger et al.). The nodes are
+           contracted one after the other; contracting v removes it and adds
+           a shortcut u -> x of weight w(u,v) + w(v,x) wherever no other
+           path is as short. The contraction order gives every node a rank.
+           A shortest path then always exists which first only goes up in
+           rank and then only down, so a query is a bidirectional Dijkstra
+           search which only goes upwards from both ends and settles a few
+           hundred nodes even on large road-like graphs.
+           The edges leading upwards from each node are kept in the upward
+           graph; the edges u -> v with u above v are kept in the downward
+           graph at v with target u (i.e. reversed), so the backward search
+           also goes upwards. Both are CompressedGraphs over node ids with
+           the middle node of a shortcut as label (NoNode() for original
+           edges), from which paths are unpacked.
+  */
+  template<typename GRAPH>
+  class ContractionHierarchy
+  {
+  public: // Types
+    typedef typename GRAPH::NodeId                              NodeId;
+    typedef typename distance_traits<typename GRAPH::Weight>::Distance Distance;
+    /// Edge u -> target with label middle
+    typedef WeightedGraphEdge<NodeId,NodeId,Distance>           Shortcut;
+    typedef CompressedGraph<Shortcut>                           SearchGraph;
+
+    inline static NodeId NoNode() { return GRAPH::NoNode(); }
+
+  public:
+    /// Constructs an empty hierarchy
+    ContractionHierarchy() {}
+
+    /// Constructs the hierarchy from its parts
+    ContractionHierarchy(std::vector<NodeId>&& rank, SearchGraph&& up, SearchGraph&& down)
+    : m_rank(std::move(rank)), m_up(std::move(up)), m_down(std::move(down))
+    {}
+
+    /// Number of nodes
+    NodeId no_of_nodes() const { return NodeId(m_rank.size()); }
+
+    /// Position of node id v in the contraction order
+    NodeId rank(NodeId v) const { return m_rank[v]; }
+
+    /// The rank of each node id
+    const std::vector<NodeId>& ranks() const { return m_rank; }
+
+    /// Edges from each node to higher ranked nodes
+    const SearchGraph& upward() const { return m_up; }
+
+    /// Edges into each node from higher ranked nodes, reversed
+    const SearchGraph& downward() const { return m_down; }
+
+    /**
+      @brief Appends the original node ids of the edge u -> x with the given
+             middle node (NoNode() for an original edge) to path, without u
+    */
+    void unpack(NodeId u, NodeId x, NodeId middle, std::vector<NodeId>& path) const
+    {
+      struct Piece { NodeId from, to, middle; };
+      std::vector<Piece> stack(1,Piece{u,x,middle});
+      while (!stack.empty()) {
+        Piece p = stack.back();
+        stack.pop_back();
+        if (p.middle == NoNode()) {
+          path.push_back(p.to);
+          continue;
+        }
+        // from -> middle is a downward edge of middle, middle -> to an
+        // upward one; the first half goes on top
+        stack.push_back(Piece{p.middle,p.to,middle_of(m_up,p.middle,p.to)});
+        stack.push_back(Piece{p.from,p.middle,middle_of(m_down,p.middle,p.from)});
+      }
+    }
+
+  private:
+    /// Label of the edge from v to w in g
+    static NodeId middle_of(const SearchGraph& g, NodeId v, NodeId w)
+    {
+      for (auto e = g.first_edge(v); e != g.last_edge(v); ++e) {
+        if (g.target(e) == w) return g.label(e);
+      }
+      return NoNode();
+    }
+
+  private:
+    std::vector<NodeId> m_rank;   ///< Contraction position of each node id
+    SearchGraph         m_up;     ///< Upward edges
+    SearchGraph         m_down;   ///< Reversed downward edges
+  }; // ContractionHierarchy
+
+  namespace detail {
+    template<typename GRAPH> class ContractionHierarchyBuilder;
+  }
+
+  /**
+    @brief build_contraction_hierarchy() preprocesses a dense graph with
+           non-negative weights. Nodes are contracted in the order of a
+           priority made of twice the edge difference (shortcuts added
+           minus edges removed), the number of contracted neighbours and
+           the depth in the hierarchy. The priorities of the neighbours
+           are recomputed after each contraction, and a node's priority is
+           checked again before it is contracted.
+    @param g the graph
+    @param witness_limit the number of nodes a witness search may settle
+           before giving up (a tenth of it when computing priorities); a
+           lower limit makes preprocessing faster but may add unnecessary
+           shortcuts, which never give wrong answers
+  */
+  template<typename GRAPH>
+  ContractionHierarchy<GRAPH> build_contraction_hierarchy(const GRAPH& g,
+                                                          std::size_t witness_limit = 500)
+  {
+    detail::ContractionHierarchyBuilder<GRAPH> builder(g,witness_limit);
+    return builder.run();
+  }
+
+  /**
+    @brief ContractionHierarchyQuery answers shortest-path queries on a
+           ContractionHierarchy. The forward search from the source runs
+           on the upward graph, the backward search from the target on the
+           downward graph; each side stops when its queue minimum reaches
+           the best path length mu found so far, and nodes reached on a
+           provably too long path are not expanded (stall-on-demand).
+           Paths are unpacked into
+           original node ids. The state is kept in two TraversalWorkspaces,
+           so repeated queries allocate nothing.
+  */
+  template<typename GRAPH>
+  class ContractionHierarchyQuery
+  {
+  public:
+    typedef ContractionHierarchy<GRAPH>             Hierarchy;
+    typedef typename Hierarchy::NodeId              NodeId;
+    typedef typename Hierarchy::Distance            Distance;
+    typedef typename Hierarchy::SearchGraph         SearchGraph;
+    typedef typename SearchGraph::EdgeIndex         EdgeIndex;
+    typedef PointToPointPath<GRAPH>                 Result;
+
+  public:
+    /// Constructor
+    explicit ContractionHierarchyQuery(const Hierarchy& ch)
+    : hierarchy(ch), side{ Side(ch.upward(),ch.downward()), Side(ch.downward(),ch.upward()) }
+    {}
+
+    /// Shortest path from node id s to node id t
+    Result run(NodeId s, NodeId t)
+    {
+      Result result;
+      if (s == Hierarchy::NoNode() || t == Hierarchy::NoNode()) return result;
+      if (s == t) {
+        result.distance = Distance();
+        result.path.push_back(s);
+        return result;
+      }
+      side[0].start(s);
+      side[1].start(t);
+
+      Distance mu = Result::Infinity();
+      NodeId meet = Hierarchy::NoNode();
+      for (;;) {
+        const bool go[2] = { side[0].active(mu), side[1].active(mu) };
+        if (!go[0] && !go[1]) break;
+        unsigned d = !go[0] ? 1 : !go[1] ? 0
+                   : (side[1].heap.top_key() < side[0].heap.top_key()) ? 1 : 0;
+        Side& self = side[d];
+        const Side& other = side[1-d];
+
+        NodeId u = self.heap.pop();
+        ++result.settled;
+        Distance du = self.workspace.distance(u);
+        self.workspace.set_color(u,Workspace::Black);
+        if (self.stalled(u,du)) continue;
+        for (EdgeIndex e = self.graph.first_edge(u); e != self.graph.last_edge(u); ++e) {
+          NodeId v = self.graph.target(e);
+          self.relax(u,v,du + self.graph.weight(e));
+          if (other.workspace.visited(v)) {
+            Distance candidate = self.workspace.distance(v) + other.workspace.distance(v);
+            if (candidate < mu) {
+              mu = candidate;
+              meet = v;
+            }
+          }
+        }
+      }
+      if (meet == Hierarchy::NoNode()) return result;
+
+      result.distance = mu;
+      // Upward half: s ... meet
+      std::vector<NodeId> up;
+      for (NodeId v = meet; v != Hierarchy::NoNode(); v = side[0].workspace.predecessor(v))
+        up.push_back(v);
+      std::reverse(up.begin(),up.end());
+      result.path.push_back(s);
+      for (std::size_t i = 0; i + 1 < up.size(); ++i)
+        hierarchy.unpack(up[i],up[i+1],middle(side[0].graph,up[i],up[i+1]),result.path);
+      // Downward half: meet ... t; the backward predecessor of v is the
+      // next node towards t
+      for (NodeId v = meet; v != t; v = side[1].workspace.predecessor(v)) {
+        NodeId w = side[1].workspace.predecessor(v);
+        hierarchy.unpack(v,w,middle(side[1].graph,w,v),result.path);
+      }
+      return result;
+    }
+
+  private:
+    typedef TraversalWorkspace<SearchGraph>       Workspace;
+    typedef detail::IndexedDaryHeap<Distance>     Heap;
+
+    /// Label of the edge from v to w in g
+    static NodeId middle(const SearchGraph& g, NodeId v, NodeId w)
+    {
+      NodeId m = Hierarchy::NoNode();
+      Distance best = Result::Infinity();
+      for (EdgeIndex e = g.first_edge(v); e != g.last_edge(v); ++e) {
+        if (g.target(e) == w && g.weight(e) < best) {
+          best = g.weight(e);
+          m = g.label(e);
+        }
+      }
+      return m;
+    }
+
+    /// State of one search direction
+    struct Side
+    {
+      Side(const SearchGraph& g, const SearchGraph& o)
+      : graph(g), opposite(o), workspace(g), heap(g.no_of_nodes()) {}
+
+      void start(NodeId s)
+      {
+        workspace.start();
+        heap.clear();
+        workspace.set_color(s,Workspace::Grey);
+        workspace.set_distance(s,Distance());
+        heap.push(s,Distance());
+      }
+
+      /**
+        @brief Stall-on-demand: if a higher node w already reached by this
+               search has an edge to u giving a shorter distance than du,
+               the path to u is not a shortest one, and neither are the
+               paths through u, so u need not be expanded. The edges into
+               u from higher nodes are those of u in the opposite graph.
+      */
+      bool stalled(NodeId u, const Distance& du) const
+      {
+        for (EdgeIndex e = opposite.first_edge(u); e != opposite.last_edge(u); ++e) {
+          NodeId w = opposite.target(e);
+          if (workspace.visited(w) && workspace.distance(w) + opposite.weight(e) < du)
+            return true;
+        }
+        return false;
+      }
+
+      /// Can this side still find a path shorter than mu?
+      bool active(const Distance& mu) const
+      {
+        return !heap.empty() && heap.top_key() < mu;
+      }
+
+      void relax(NodeId u, NodeId v, const Distance& dv)
+      {
+        if (!workspace.visited(v)) {
+          workspace.set_color(v,Workspace::Grey);
+          workspace.set_distance(v,dv);
+          workspace.set_predecessor(v,u);
+          heap.push(v,dv);
+        }
+        else if (workspace.color(v) == Workspace::Grey && dv < workspace.distance(v)) {
+          workspace.set_distance(v,dv);
+          workspace.set_predecessor(v,u);
+          heap.decrease_key(v,dv);
+        }
+      }
+
+      const SearchGraph& graph;     ///< The graph searched
+      const SearchGraph& opposite;  ///< The graph of the other direction
+      Workspace workspace;
+      Heap heap;
+    };
+
+    const Hierarchy& hierarchy;
+    Side side[2];         ///< Upward and downward search
+  }; // ContractionHierarchyQuery
+
+  /// Shortest path from node id s to node id t with a temporary query
+  /// object; keep a ContractionHierarchyQuery for many queries
+  template<typename GRAPH>
+  PointToPointPath<GRAPH> ch_shortest_path(const ContractionHierarchy<GRAPH>& ch,
+                                           typename GRAPH::NodeId s, typename GRAPH::NodeId t)
+  {
+    ContractionHierarchyQuery<GRAPH> query(ch);
+    return query.run(s,t);
+  }
+
+  /*
+    Contraction hierarchy file format, version 1. All numbers are
+    little-endian; D is the distance type.
+
+    Header (128 bytes):
+      char   magic[8]        "MCCHIER\0"
+      uint32 version         1
+      uint32 distance_kind   0 unsigned, 1 signed integer, 2 floating point
+      uint32 distance_size   sizeof(D)
+      uint32 reserved
+      uint64 no_of_nodes     n
+      uint64 no_of_up        m_up
+      uint64 no_of_down      m_down
+      uint64 section[10]     file offsets of the sections below
+
+    Sections (each starts at a multiple of 8):
+      0 rank          uint32[n]
+      1 nodes         uint32[n]       0..n-1, the node array of both graphs
+      2 up_offsets    uint64[n+1]
+      3 up_targets    uint32[m_up]
+      4 up_middles    uint32[m_up]
+      5 up_weights    D[m_up]
+      6-9             the same for the downward graph
+  */
+
+  namespace detail {
+
+    const char          ch_file_magic[8]    = { 'M','C','C','H','I','E','R','\0' };
+    const std::uint32_t ch_file_version     = 1;
+    const std::size_t   ch_file_header_size = 128;
+    const unsigned      ch_file_sections    = 10;
+
+    template<typename DISTANCE>
+    std::uint32_t ch_distance_kind()
+    {
+      return std::is_floating_point<DISTANCE>::value ? 2 : std::is_signed<DISTANCE>::value ? 1 : 0;
+    }
+
+  } // namespace detail
+
+  /// Writes the contraction hierarchy ch to a file (see the format above)
+  template<typename GRAPH>
+  void write_contraction_hierarchy(const std::string& path, const ContractionHierarchy<GRAPH>& ch)
+  {
+    typedef ContractionHierarchy<GRAPH>           Hierarchy;
+    typedef typename Hierarchy::NodeId            NodeId;
+    typedef typename Hierarchy::Distance          Distance;
+    typedef typename Hierarchy::SearchGraph       SearchGraph;
+    static_assert(sizeof(NodeId) == 4,"hierarchy files store 32 bit node ids");
+    if (!detail::host_is_little_endian())
+      throw std::runtime_error("hierarchy files can only be written on little-endian machines");
+
+    const SearchGraph& up = ch.upward();
+    const SearchGraph& down = ch.downward();
+    std::uint64_t sizes[detail::ch_file_sections] = {
+      ch.ranks().size() * sizeof(NodeId),
+      up.nodes().size() * sizeof(NodeId),
+      up.offset_array().size() * sizeof(std::uint64_t),
+      up.target_array().size() * sizeof(NodeId),
+      up.label_array().size() * sizeof(NodeId),
+      up.weight_array().size() * sizeof(Distance),
+      down.offset_array().size() * sizeof(std::uint64_t),
+      down.target_array().size() * sizeof(NodeId),
+      down.label_array().size() * sizeof(NodeId),
+      down.weight_array().size() * sizeof(Distance)
+    };
+    const void* data[detail::ch_file_sections] = {
+      ch.ranks().data(), up.nodes().data(), up.offset_array().data(),
+      up.target_array().data(), up.label_array().data(), up.weight_array().data(),
+      down.offset_array().data(), down.target_array().data(),
+      down.label_array().data(), down.weight_array().data()
+    };
+
+    unsigned char header[detail::ch_file_header_size];
+    std::memset(header,0,sizeof(header));
+    std::memcpy(header,detail::ch_file_magic,8);
+    detail::put_u32(header+8,detail::ch_file_version);
+    detail::put_u32(header+12,detail::ch_distance_kind<Distance>());
+    detail::put_u32(header+16,sizeof(Distance));
+    detail::put_u64(header+24,ch.no_of_nodes());
+    detail::put_u64(header+32,up.no_of_edges());
+    detail::put_u64(header+40,down.no_of_edges());
+    std::uint64_t pos = detail::ch_file_header_size;
+    for (unsigned i = 0; i < detail::ch_file_sections; ++i) {
+      detail::put_u64(header+48+8*i,pos);
+      pos = (pos + sizes[i] + 7) / 8 * 8;
+    }
+
+    std::ofstream out(path.c_str(),std::ios::binary);
+    if (!out)
+      throw std::runtime_error("cannot create " + path);
+    out.write(reinterpret_cast<const char*>(header),sizeof(header));
+    const char padding[8] = { 0 };
+    for (unsigned i = 0; i < detail::ch_file_sections; ++i) {
+      if (sizes[i] > 0)
+        out.write(static_cast<const char*>(data[i]),sizes[i]);
+      out.write(padding,(8 - sizes[i] % 8) % 8);
+    }
+    if (!out)
+      throw std::runtime_error("error writing " + path);
+  }
+
+  namespace detail {
+    /// Checks that the ranks of a hierarchy file are a permutation
+    template<typename NODEID>
+    void check_ch_file_ranks(const std::vector<NODEID>& rank, const std::string& path)
+    {
+      const NODEID n = NODEID(rank.size());
+      std::vector<char> seen(n,0);
+      for (NODEID v = 0; v < n; ++v) {
+        if (rank[v] >= n || seen[rank[v]])
+          throw std::runtime_error(path + " is corrupt");
+        seen[rank[v]] = 1;
+      }
+    }
+
+    /**
+      @brief Checks one search graph of a hierarchy file with the checked
+             ranks rank in O(n+m) and throws std::runtime_error if it is
+             corrupt. The node array must be the identity; every edge must
+             lead from v to a higher ranked node and have no middle node
+             or one ranked below v (and so below both ends). Then
+             unpacking a shortcut always ends, since the ranks of the
+             pieces decrease, and never leaves the graphs.
+    */
+    template<typename NODEID, typename SEARCHGRAPH>
+    void check_ch_file_graph(const std::vector<NODEID>& rank, const SEARCHGRAPH& g,
+                             const std::string& path)
+    {
+      const NODEID n = NODEID(rank.size());
+      check_file_csr(g.offset_array(),g.target_array(),n,path);
+      for (NODEID v = 0; v < n; ++v) {
+        if (g.node(v) != v)
+          throw std::runtime_error(path + " is corrupt");
+        for (auto e = g.first_edge(v); e != g.last_edge(v); ++e) {
+          NODEID middle = g.label(e);
+          if (!(rank[v] < rank[g.target(e)]) ||
+              (middle != SEARCHGRAPH::NoNode() && (middle >= n || !(rank[middle] < rank[v]))))
+            throw std::runtime_error(path + " is corrupt");
+        }
+      }
+    }
+  }
+
+  /**
+    @brief Maps a file written by write_contraction_hierarchy(). The
+           upward and downward graphs refer directly to the mapping (like
+           MappedGraphFile), only the rank array is copied. Throws
+           std::runtime_error if the file does not fit GRAPH or is
+           corrupt; all arrays are checked in O(n+m).
+  */
+  template<typename GRAPH>
+  ContractionHierarchy<GRAPH> read_contraction_hierarchy(const std::string& path)
+  {
+    typedef ContractionHierarchy<GRAPH>           Hierarchy;
+    typedef typename Hierarchy::NodeId            NodeId;
+    typedef typename Hierarchy::Distance          Distance;
+    typedef typename Hierarchy::SearchGraph       SearchGraph;
+    typedef typename SearchGraph::EdgeIndex       EdgeIndex;
+    if (!detail::host_is_little_endian())
+      throw std::runtime_error("hierarchy files can only be mapped on little-endian machines");
+
+    std::shared_ptr<detail::FileMapping> mapping(new detail::FileMapping(path));
+    const unsigned char* p = mapping->data();
+    std::size_t size = mapping->size();
+
+    if (size < detail::ch_file_header_size || std::memcmp(p,detail::ch_file_magic,8) != 0)
+      throw std::runtime_error(path + " is not a contraction hierarchy file");
+    if (detail::get_u32(p+8) != detail::ch_file_version)
+      throw std::runtime_error(path + " has an unsupported version");
+    if (detail::get_u32(p+12) != detail::ch_distance_kind<Distance>() ||
+        detail::get_u32(p+16) != sizeof(Distance))
+      throw std::runtime_error(path + " does not match the distance type");
+
+    std::uint64_t n = detail::get_u64(p+24);
+    std::uint64_t mu = detail::get_u64(p+32);
+    std::uint64_t md = detail::get_u64(p+40);
+    if (n >= Hierarchy::NoNode())
+      throw std::runtime_error(path + " is truncated or corrupt");
+    std::uint64_t counts[detail::ch_file_sections] = { n, n, n+1, mu, mu, mu, n+1, md, md, md };
+    std::uint64_t widths[detail::ch_file_sections] = {
+      4, 4, 8, 4, 4, sizeof(Distance), 8, 4, 4, sizeof(Distance)
+    };
+    const unsigned char* sections[detail::ch_file_sections];
+    detail::locate_file_sections(p,size,p+48,detail::ch_file_sections,
+                                 counts,widths,sections,path);
+    detail::check_file_offsets(sections[2],n,mu,path);
+    detail::check_file_offsets(sections[6],n,md,path);
+
+    const NodeId* rank = reinterpret_cast<const NodeId*>(sections[0]);
+    detail::ArrayRef<NodeId> nodes(reinterpret_cast<const NodeId*>(sections[1]),n);
+    SearchGraph up(nodes,
+      detail::ArrayRef<EdgeIndex>(reinterpret_cast<const EdgeIndex*>(sections[2]),n+1),
+      detail::ArrayRef<NodeId>(reinterpret_cast<const NodeId*>(sections[3]),mu),
+      detail::ArrayRef<NodeId>(reinterpret_cast<const NodeId*>(sections[4]),mu),
+      detail::ArrayRef<Distance>(reinterpret_cast<const Distance*>(sections[5]),mu),
+      mapping);
+    SearchGraph down(nodes,
+      detail::ArrayRef<EdgeIndex>(reinterpret_cast<const EdgeIndex*>(sections[6]),n+1),
+      detail::ArrayRef<NodeId>(reinterpret_cast<const NodeId*>(sections[7]),md),
+      detail::ArrayRef<NodeId>(reinterpret_cast<const NodeId*>(sections[8]),md),
+      detail::ArrayRef<Distance>(reinterpret_cast<const Distance*>(sections[9]),md),
+      mapping);
+    std::vector<NodeId> ranks(rank,rank + n);
+    detail::check_ch_file_ranks(ranks,path);
+    detail::check_ch_file_graph(ranks,up,path);
+    detail::check_ch_file_graph(ranks,down,path);
+    return Hierarchy(std::move(ranks),std::move(up),std::move(down));
+  }
+
+  namespace detail {
+  /**
+    @brief Contracts the nodes of a dense graph one by one. The remaining
+           graph is kept as in- and out-arc lists with at most one arc per
+           node pair. Witness searches are Dijkstra searches in the
+           remaining graph without the node being contracted, bounded by
+           the longest path through it and by a number of settled nodes.
+  */
+  template<typename GRAPH>
+  class ContractionHierarchyBuilder
+  {
+  public:
+    typedef ContractionHierarchy<GRAPH>           Hierarchy;
+    typedef typename Hierarchy::NodeId            NodeId;
+    typedef typename Hierarchy::Distance          Distance;
+    typedef typename Hierarchy::SearchGraph       SearchGraph;
+    typedef typename GRAPH::EdgeIndex             EdgeIndex;
+    typedef std::int64_t                          Priority;
+
+  public:
+    /// Constructor
+    ContractionHierarchyBuilder(const GRAPH& g, std::size_t limit)
+    : graph(g), witness_limit(limit), simulation_limit(std::max<std::size_t>(limit / 10,1)),
+      out(g.no_of_nodes()), in(g.no_of_nodes()),
+      up(g.no_of_nodes()), down(g.no_of_nodes()), contracted_neighbours(g.no_of_nodes(),0),
+      level(g.no_of_nodes(),0),
+      rank(g.no_of_nodes(),Hierarchy::NoNode()), stamp(g.no_of_nodes(),0), epoch(0),
+      distance(g.no_of_nodes()), is_target(g.no_of_nodes(),0), heap(g.no_of_nodes()), order(g.no_of_nodes())
+    {}
+
+    /// Contracts all nodes
+    Hierarchy run()
+    {
+      const NodeId n = graph.no_of_nodes();
+      for (NodeId u = 0; u < n; ++u) {
+        for (EdgeIndex e = graph.first_edge(u); e != graph.last_edge(u); ++e) {
+          if (graph.target(e) != u)
+            add_arc(u,graph.target(e),Distance(graph.weight(e)),Hierarchy::NoNode());
+        }
+      }
+      for (NodeId v = 0; v < n; ++v) order.push(v,priority(v));
+
+      for (NodeId next = 0; !order.empty(); ) {
+        NodeId v = order.pop();
+        // Lazy update: contract v only if it is still the best choice
+        Priority p = priority(v);
+        if (!order.empty() && order.top_key() < p) {
+          order.push(v,p);
+          continue;
+        }
+        contract(v);
+        rank[v] = next++;
+      }
+      return Hierarchy(std::move(rank),make_graph(up),make_graph(down));
+    }
+
+  private:
+    /// Arc to or from node
+    struct Arc
+    {
+      NodeId   node;
+      Distance weight;
+      NodeId   middle;
+    };
+    typedef std::vector<Arc> ArcList;
+
+    struct Shortcut
+    {
+      NodeId   from, to;
+      Distance weight;
+    };
+
+    static Arc* find(ArcList& arcs, NodeId v)
+    {
+      for (auto a = arcs.begin(); a != arcs.end(); ++a) {
+        if (a->node == v) return &*a;
+      }
+      return 0;
+    }
+
+    static void erase(ArcList& arcs, NodeId v)
+    {
+      for (auto a = arcs.begin(); a != arcs.end(); ++a) {
+        if (a->node == v) {
+          *a = arcs.back();
+          arcs.pop_back();
+          return;
+        }
+      }
+    }
+
+    /// Adds arc u -> x or shortens the existing one
+    void add_arc(NodeId u, NodeId x, const Distance& w, NodeId middle)
+    {
+      Arc* a = find(out[u],x);
+      if (!a) {
+        out[u].push_back(Arc{x,w,middle});
+        in[x].push_back(Arc{u,w,middle});
+      }
+      else if (w < a->weight) {
+        *a = Arc{x,w,middle};
+        *find(in[x],u) = Arc{u,w,middle};
+      }
+    }
+
+    /// Shortcuts needed when v is contracted; the witness searches settle
+    /// at most limit nodes
+    void find_shortcuts(NodeId v, std::size_t limit, std::vector<Shortcut>& shortcuts)
+    {
+      shortcuts.clear();
+      if (out[v].empty()) return;
+      Distance longest = Distance();
+      for (auto a = out[v].begin(); a != out[v].end(); ++a) {
+        longest = std::max(longest,a->weight);
+        is_target[a->node] = 1;
+      }
+      for (auto a = in[v].begin(); a != in[v].end(); ++a) {
+        witness_search(a->node,v,a->weight + longest,out[v].size(),limit);
+        for (auto b = out[v].begin(); b != out[v].end(); ++b) {
+          if (b->node == a->node) continue;
+          Distance through = a->weight + b->weight;
+          if (!reached(b->node) || through < distance[b->node])
+            shortcuts.push_back(Shortcut{a->node,b->node,through});
+        }
+      }
+      for (auto a = out[v].begin(); a != out[v].end(); ++a) is_target[a->node] = 0;
+    }
+
+    /// Dijkstra search from s avoiding v; stops when the targets are
+    /// settled, beyond distance bound or after limit settled nodes
+    void witness_search(NodeId s, NodeId v, const Distance& bound, std::size_t targets,
+                        std::size_t limit)
+    {
+      if (++epoch == 0) {
+        std::fill(stamp.begin(),stamp.end(),0);
+        epoch = 1;
+      }
+      heap.clear();
+      stamp[s] = epoch;
+      distance[s] = Distance();
+      heap.push(s,Distance());
+      for (std::size_t settled = 0; !heap.empty() && settled < limit; ++settled) {
+        if (bound < heap.top_key()) break;
+        NodeId u = heap.pop();
+        if (is_target[u] && --targets == 0) break;
+        for (auto a = out[u].begin(); a != out[u].end(); ++a) {
+          if (a->node == v) continue;
+          Distance d = distance[u] + a->weight;
+          if (!reached(a->node)) {
+            stamp[a->node] = epoch;
+            distance[a->node] = d;
+            heap.push(a->node,d);
+          }
+          else if (d < distance[a->node]) {
+            distance[a->node] = d;
+            if (heap.contains(a->node)) heap.decrease_key(a->node,d);
+          }
+        }
+      }
+    }
+
+    bool reached(NodeId v) const { return stamp[v] == epoch; }
+
+    /// Contraction priority of v; smaller is earlier
+    Priority priority(NodeId v)
+    {
+      find_shortcuts(v,simulation_limit,shortcuts);
+      return 2 * (Priority(shortcuts.size()) - Priority(in[v].size() + out[v].size()))
+             + Priority(contracted_neighbours[v]) + Priority(level[v]);
+    }
+
+    /// Removes v from the remaining graph
+    void contract(NodeId v)
+    {
+      find_shortcuts(v,witness_limit,shortcuts);
+      up[v] = out[v];
+      down[v] = in[v];
+      for (auto a = out[v].begin(); a != out[v].end(); ++a) {
+        erase(in[a->node],v);
+        ++contracted_neighbours[a->node];
+        level[a->node] = std::max(level[a->node],level[v] + 1);
+      }
+      for (auto a = in[v].begin(); a != in[v].end(); ++a) {
+        erase(out[a->node],v);
+        ++contracted_neighbours[a->node];
+        level[a->node] = std::max(level[a->node],level[v] + 1);
+      }
+      for (auto s = shortcuts.begin(); s != shortcuts.end(); ++s) {
+        add_arc(s->from,s->to,s->weight,v);
+      }
+      // The neighbours' priorities changed; most are in- and out-neighbours
+      neighbours.clear();
+      for (auto a = up[v].begin(); a != up[v].end(); ++a) neighbours.push_back(a->node);
+      for (auto a = down[v].begin(); a != down[v].end(); ++a) neighbours.push_back(a->node);
+      std::sort(neighbours.begin(),neighbours.end());
+      neighbours.erase(std::unique(neighbours.begin(),neighbours.end()),neighbours.end());
+      for (auto u = neighbours.begin(); u != neighbours.end(); ++u) update(*u);
+      ArcList().swap(out[v]);
+      ArcList().swap(in[v]);
+    }
+
+    void update(NodeId u)
+    {
+      if (order.contains(u)) order.update(u,priority(u));
+    }
+
+    /// CSR graph of the arc lists
+    static SearchGraph make_graph(const std::vector<ArcList>& arcs)
+    {
+      const NodeId n = NodeId(arcs.size());
+      typename SearchGraph::NodeVector nodes(n);
+      std::vector<typename SearchGraph::EdgeIndex> offsets(n+1,0);
+      for (NodeId v = 0; v < n; ++v) {
+        nodes[v] = v;
+        offsets[v+1] = offsets[v] + arcs[v].size();
+      }
+      std::vector<NodeId> targets, middles;
+      std::vector<Distance> weights;
+      targets.reserve(offsets.back());
+      middles.reserve(offsets.back());
+      weights.reserve(offsets.back());
+      for (NodeId v = 0; v < n; ++v) {
+        for (auto a = arcs[v].begin(); a != arcs[v].end(); ++a) {
+          targets.push_back(a->node);
+          middles.push_back(a->middle);
+          weights.push_back(a->weight);
+        }
+      }
+      return SearchGraph(std::move(nodes),std::move(offsets),std::move(targets),
+                         std::move(middles),std::move(weights));
+    }
+
+  private: // Member variables
+    const GRAPH& graph;
+    const std::size_t witness_limit;             ///< Settled nodes per witness search
+    const std::size_t simulation_limit;          ///< The same when computing priorities
+    std::vector<ArcList> out, in;                 ///< Arcs of the remaining graph
+    std::vector<ArcList> up, down;                ///< Arcs of the contracted nodes
+    std::vector<std::uint32_t> contracted_neighbours;
+    std::vector<std::uint32_t> level;
+    std::vector<NodeId> rank;
+    std::vector<std::uint32_t> stamp;             ///< Witness search of each distance
+    std::uint32_t epoch;
+    std::vector<Distance> distance;               ///< Witness search distances
+    std::vector<unsigned char> is_target;         ///< Out-neighbours of the node being contracted
+    IndexedDaryHeap<Distance> heap;               ///< Witness search queue
+    IndexedDaryHeap<Priority> order;              ///< Contraction order
+    std::vector<Shortcut> shortcuts;
+    std::vector<NodeId> neighbours;
+  }; // ContractionHierarchyBuilder
+
+  } // namespace detail
+
+} // namespace MyCoolGraphLibrary
+
+#endif
@@ -0,0 +1,270 @@
+////////////////////////////////////////////////////////////////////////////////
+// deltastepping.hpp
+// Parallel single-source shortest paths with delta-stepping
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DELTASTEPPING_HPP__
+#define __DELTASTEPPING_HPP__
+
+#include <vector>
+#include <atomic>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+
+#include "compressedgraph.hpp"
+#include "priorityqueues.hpp"
+#include "parallel.hpp"
+
+namespace MyCoolGraphLibrary {
+
+  namespace detail {
+    template<typename GRAPH> class DeltaStepping;
+  }
+
+  /**
+    @brief delta_stepping() computes the distances from start to all node
+           ids of a dense graph with non-negative weights on the threads of
+           pool (Meyer and Sanders' delta-stepping). The result is the same
+           as that of shortest_paths(); unreachable nodes get the largest
+           value of the distance type.
+           Nodes are kept in buckets of width delta by tentative distance.
+           The smallest bucket is emptied in parallel rounds which relax
+           the light edges (weight <= delta) until no node falls back into
+           it; then the heavy edges of all nodes removed from it are relaxed
+           once. A small delta approaches Dijkstra's algorithm (little
+           parallelism per bucket), a large one Bellman-Ford (many repeated
+           relaxations). The average edge weight times a small factor is a
+           reasonable start. Only the buckets within the largest edge
+           weight of the current one can be filled, so each thread keeps
+           a ring of about largest weight / delta buckets.
+           Throws std::invalid_argument if delta is not positive or so
+           small that the ring would need 2^32 or more buckets.
+    @param g the graph (a dense graph like CompressedGraph)
+    @param start the start node
+    @param delta the bucket width (> 0)
+    @param pool the worker threads
+  */
+  template<typename GRAPH>
+  std::vector<typename distance_traits<typename GRAPH::Weight>::Distance>
+  delta_stepping(const GRAPH& g, const typename GRAPH::Node& start,
+                 typename distance_traits<typename GRAPH::Weight>::Distance delta,
+                 ThreadPool& pool)
+  {
+    typedef typename distance_traits<typename GRAPH::Weight>::Distance Distance;
+    // Also rejects NaN
+    if (!(Distance() < delta))
+      throw std::invalid_argument("delta_stepping(): delta must be positive");
+    detail::DeltaStepping<GRAPH> sssp_algorithm(g,pool,delta);
+    return sssp_algorithm.run(g.id(start));
+  }
+
+  /// Same as above, with a temporary pool of nthreads threads
+  template<typename GRAPH>
+  std::vector<typename distance_traits<typename GRAPH::Weight>::Distance>
+  delta_stepping(const GRAPH& g, const typename GRAPH::Node& start,
+                 typename distance_traits<typename GRAPH::Weight>::Distance delta,
+                 unsigned nthreads = detail::default_concurrency())
+  {
+    ThreadPool pool(nthreads);
+    return delta_stepping(g,start,delta,pool);
+  }
+
+  namespace detail {
+  /**
+    @brief Delta-stepping on dense node ids. The tentative distances are
+           atomics and only ever lowered with a compare-and-swap loop
+           (atomic min); the thread whose update succeeds puts the target
+           into its own bucket of the new distance. Buckets are per thread,
+           so inserting takes no lock; the threads' parts of the current
+           bucket are joined at prefix-sum offsets like the frontiers in
+           ParallelBFS. A node may be in several buckets; an entry is
+           skipped if the node's distance has since moved it to another
+           bucket.
+           A node is only inserted with the distance of a node of the
+           current bucket plus an edge weight, so all entries are in the
+           largest weight / delta + 2 buckets from the current one (one
+           more is kept against rounding of floating-point distances).
+           These are kept in a ring: bucket b is slot b % ring_size.
+  */
+  template<typename GRAPH>
+  class DeltaStepping
+  {
+  public:
+    typedef typename GRAPH::NodeId      NodeId;
+    typedef typename GRAPH::EdgeIndex   EdgeIndex;
+    typedef typename distance_traits<typename GRAPH::Weight>::Distance Distance;
+    typedef std::vector<NodeId>         Bucket;
+
+  public:
+    /// Constructor
+    DeltaStepping(const GRAPH& g, ThreadPool& pool, Distance d)
+    : graph(g), threads(pool), delta(d), ring_size(ring_buckets(g,d)),
+      distance(g.no_of_nodes()), removed_in(g.no_of_nodes()), buckets(pool.size()),
+      removed(pool.size())
+    {}
+
+    /// Distances from node id s
+    std::vector<Distance> run(NodeId s)
+    {
+      const NodeId n = graph.no_of_nodes();
+      const unsigned nt = threads.size();
+      threads.run([&](unsigned t) {
+        for (NodeId v = chunk_begin(n,t,nt); v < chunk_begin(n,t+1,nt); ++v) {
+          distance[v].store(Infinity(),std::memory_order_relaxed);
+          removed_in[v].store(NoBucket(),std::memory_order_relaxed);
+        }
+        buckets[t].clear();
+      });
+
+      if (s != GRAPH::NoNode()) {
+        distance[s].store(Distance(),std::memory_order_relaxed);
+        insert(0,s,Distance());
+        std::vector<NodeId> frontier;
+        for (std::size_t current = 0; next_bucket(current); ++current) {
+          // Light edges, until the bucket stays empty
+          for (gather(current,frontier); !frontier.empty(); gather(current,frontier)) {
+            relax_light(frontier,current);
+          }
+          // Heavy edges of all nodes removed from the bucket
+          relax_heavy();
+        }
+      }
+
+      std::vector<Distance> result(n);
+      threads.run([&](unsigned t) {
+        for (NodeId v = chunk_begin(n,t,nt); v < chunk_begin(n,t+1,nt); ++v)
+          result[v] = distance[v].load(std::memory_order_relaxed);
+      });
+      return result;
+    }
+
+  private:
+    inline static Distance Infinity() { return std::numeric_limits<Distance>::max(); }
+    inline static std::size_t NoBucket() { return std::size_t(-1); }
+
+    /// Number of buckets in the ring for graph g and bucket width d
+    static std::size_t ring_buckets(const GRAPH& g, const Distance& d)
+    {
+      const double buckets = double(max_edge_weight(g)) / double(d);
+      if (!(buckets < 4294967296.0))
+        throw std::invalid_argument("delta_stepping(): delta is too small for the edge weights");
+      return std::size_t(buckets) + 3;
+    }
+
+    std::size_t bucket_of(const Distance& d) const { return std::size_t(d / delta); }
+
+    /// Bucket b of thread t, which must exist
+    Bucket& slot(unsigned t, std::size_t b) { return buckets[t][b % ring_size]; }
+
+    /// Does thread t have entries in bucket b?
+    bool has_entries(unsigned t, std::size_t b) const
+    {
+      return b % ring_size < buckets[t].size() && !buckets[t][b % ring_size].empty();
+    }
+
+    /// Puts v with distance d into the buckets of thread t; the ring
+    /// grows to its full size only if the distances need it
+    void insert(unsigned t, NodeId v, const Distance& d)
+    {
+      std::size_t b = bucket_of(d) % ring_size;
+      if (buckets[t].size() <= b) buckets[t].resize(b + 1);
+      buckets[t][b].push_back(v);
+    }
+
+    /// Lowers the distance of v to d; true if d was smaller
+    bool lower(NodeId v, const Distance& d)
+    {
+      Distance old = distance[v].load(std::memory_order_relaxed);
+      while (d < old) {
+        if (distance[v].compare_exchange_weak(old,d,std::memory_order_relaxed)) return true;
+      }
+      return false;
+    }
+
+    /// Sets current to the first non-empty bucket at or after it
+    bool next_bucket(std::size_t& current) const
+    {
+      for (std::size_t b = current; b < current + ring_size; ++b) {
+        for (unsigned t = 0; t < threads.size(); ++t) {
+          if (has_entries(t,b)) {
+            current = b;
+            return true;
+          }
+        }
+      }
+      return false;
+    }
+
+    /// Moves bucket b of all threads into frontier
+    void gather(std::size_t b, std::vector<NodeId>& frontier)
+    {
+      const Bucket none;
+      frontier.clear();
+      parallel_append(threads,frontier,
+        [&](unsigned t) -> const Bucket& { return has_entries(t,b) ? slot(t,b) : none; },
+        [&](unsigned t) { if (has_entries(t,b)) slot(t,b).clear(); });
+    }
+
+    /// Relaxes the light edges of the nodes in frontier which still
+    /// belong to bucket current and records them as removed
+    void relax_light(const std::vector<NodeId>& frontier, std::size_t current)
+    {
+      const std::size_t block = 64;
+      std::atomic<std::size_t> position(0);
+      threads.run([&](unsigned t) {
+        for (;;) {
+          std::size_t b = position.fetch_add(block,std::memory_order_relaxed);
+          if (b >= frontier.size()) break;
+          std::size_t e = std::min(b + block,frontier.size());
+          for (std::size_t i = b; i < e; ++i) {
+            NodeId u = frontier[i];
+            Distance du = distance[u].load(std::memory_order_relaxed);
+            if (bucket_of(du) != current) continue;   // stale entry
+            if (removed_in[u].exchange(current,std::memory_order_relaxed) != current)
+              removed[t].push_back(u);
+            for (EdgeIndex k = graph.first_edge(u); k != graph.last_edge(u); ++k) {
+              Distance w = Distance(graph.weight(k));
+              if (delta < w) continue;
+              NodeId v = graph.target(k);
+              if (lower(v,du + w)) insert(t,v,du + w);
+            }
+          }
+        }
+      });
+    }
+
+    /// Relaxes the heavy edges of the removed nodes
+    void relax_heavy()
+    {
+      threads.run([&](unsigned t) {
+        for (auto u = removed[t].begin(); u != removed[t].end(); ++u) {
+          Distance du = distance[*u].load(std::memory_order_relaxed);
+          for (EdgeIndex k = graph.first_edge(*u); k != graph.last_edge(*u); ++k) {
+            Distance w = Distance(graph.weight(k));
+            if (!(delta < w)) continue;
+            NodeId v = graph.target(k);
+            if (lower(v,du + w)) insert(t,v,du + w);
+          }
+        }
+        removed[t].clear();
+      });
+    }
+
+  private: // Member variables
+    const GRAPH& graph;
+    ThreadPool& threads;
+    const Distance delta;                                 ///< Bucket width
+    const std::size_t ring_size;                          ///< Buckets in the ring
+    std::vector< std::atomic<Distance> > distance;        ///< Tentative distance of each node
+    std::vector< std::atomic<std::size_t> > removed_in;   ///< Bucket a node was last removed from
+    std::vector< std::vector<Bucket> > buckets;           ///< Bucket ring per thread
+    std::vector< std::vector<NodeId> > removed;           ///< Removed nodes per thread
+  }; // DeltaStepping
+
+  } // namespace detail
+} // namespace MyCoolGraphLibrary
+
+#endif
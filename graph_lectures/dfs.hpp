@@ -8,14 +8,94 @@
 #define __DFS_HPP__
 
 #include <map>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <memory_resource>
+#include <type_traits>
 
 #include "labeledgraph.hpp"
+#include "compressedgraph.hpp"
+#include "traversalworkspace.hpp"
 
 namespace MyCoolGraphLibrary {
   
   // Forward declaration of embedded class
   namespace detail {
-    template<typename GRAPHEDGE> class GraphDFSSearch;
+    template<typename GRAPH, bool DENSE = is_dense_graph<GRAPH>::value> 
+    class GraphDFSSearch;
+    template<typename GRAPH> class DFSEngine;
+  }
+
+  /**
+    @brief DFSVisitor is the base class for visitors of depth_first_visit().
+           Derive from it and hide the hooks you need; the others stay empty
+           inline functions which the compiler removes, so a visitor pays
+           only for the events it handles. Nodes are node ids and edges are
+           edge indices of the dense graph.
+           Edges are classified when they are followed from source:
+           to a white node (tree edge), to a grey node on the current path
+           (back edge, i.e. a cycle) or to a black node (forward or cross
+           edge).
+  */
+  template<typename GRAPH>
+  struct DFSVisitor
+  {
+    typedef typename GRAPH::NodeId      NodeId;
+    typedef typename GRAPH::EdgeIndex   EdgeIndex;
+
+    /// Node u gets grey
+    void discover_node(NodeId) {}
+    /// Node u gets black (all its out-edges are done)
+    void finish_node(NodeId) {}
+    /// Edge e from source leads to a newly discovered node
+    void tree_edge(NodeId, EdgeIndex) {}
+    /// Edge e from source leads to a grey node
+    void back_edge(NodeId, EdgeIndex) {}
+    /// Edge e from source leads to a black node
+    void forward_or_cross_edge(NodeId, EdgeIndex) {}
+    /// Checked after every event; true ends the search
+    bool stop() const { return false; }
+  };
+
+  /**
+    @brief depth_first_visit() runs an iterative depth-first search on a
+           dense graph from start and reports its events to visitor (see
+           DFSVisitor)
+    @return false if the visitor stopped the search
+  */
+  template<typename GRAPH, typename VISITOR>
+  bool depth_first_visit(const GRAPH& g,
+                         const typename GRAPH::Node& start,
+                         VISITOR& visitor)
+  {
+    TraversalWorkspace<GRAPH> workspace(g);
+    workspace.start();
+    detail::DFSEngine<GRAPH> dfs_algorithm(g,workspace);
+    return dfs_algorithm.visit_from(g.id(start),visitor);
+  }
+
+  /// Same as above with a reusable workspace
+  template<typename GRAPH, typename VISITOR>
+  bool depth_first_visit(const GRAPH& g,
+                         const typename GRAPH::Node& start,
+                         VISITOR& visitor,
+                         TraversalWorkspace<GRAPH>& workspace)
+  {
+    workspace.start();
+    detail::DFSEngine<GRAPH> dfs_algorithm(g,workspace);
+    return dfs_algorithm.visit_from(g.id(start),visitor);
+  }
+
+  /// depth_first_visit() for all nodes: starts a search from every node
+  /// (in id order) which is still white
+  template<typename GRAPH, typename VISITOR>
+  bool depth_first_visit(const GRAPH& g, VISITOR& visitor)
+  {
+    TraversalWorkspace<GRAPH> workspace(g);
+    workspace.start();
+    detail::DFSEngine<GRAPH> dfs_algorithm(g,workspace);
+    return dfs_algorithm.visit_all(visitor);
   }
   
   /**
@@ -24,52 +104,88 @@ namespace MyCoolGraphLibrary {
     @param start the start node of the graph
     @param the visitor object
   */  
-  template<typename GRAPHEDGE, typename VISITOR>
-  void depth_first_search(const LabeledDirectedGraph<GRAPHEDGE>& g, 
-                          const typename GRAPHEDGE::Node& start, 
+  template<typename GRAPH, typename VISITOR>
+  void depth_first_search(const GRAPH& g, 
+                          const typename GRAPH::Node& start, 
                           VISITOR& visitor)
   {
     // Instantiate the algorithm with the given graph
-    detail::GraphDFSSearch<GRAPHEDGE> dfs_algorithm(g);
+    detail::GraphDFSSearch<GRAPH> dfs_algorithm(g);
     // Start the search at the node
     dfs_algorithm.dfs(start,visitor);
   }
 
+  /**
+    @brief Same as above for dense graphs, but the node colors are kept in
+           a workspace which is reused by later searches
+  */
+  template<typename GRAPH, typename VISITOR>
+  void depth_first_search(const GRAPH& g,
+                          const typename GRAPH::Node& start,
+                          VISITOR& visitor,
+                          TraversalWorkspace<GRAPH>& workspace)
+  {
+    detail::GraphDFSSearch<GRAPH> dfs_algorithm(g,workspace);
+    dfs_algorithm.dfs(start,visitor);
+  }
+
+  /**
+    @brief Same as the first version for generic graphs, but the colors
+           and the stack are allocated from the memory resource r (e.g. a
+           std::pmr::monotonic_buffer_resource). Dense graphs keep their
+           state in a TraversalWorkspace instead.
+  */
+  template<typename GRAPH, typename VISITOR>
+  typename std::enable_if<!is_dense_graph<GRAPH>::value>::type
+  depth_first_search(const GRAPH& g,
+                     const typename GRAPH::Node& start,
+                     VISITOR& visitor,
+                     std::pmr::memory_resource* r)
+  {
+    detail::GraphDFSSearch<GRAPH> dfs_algorithm(g,true,r);
+    dfs_algorithm.dfs(start,visitor);
+  }
+
   /** 
     @brief depth_first_search() implements depth-first search for all graph nodes
     @param g the graph to be searched
     @param visitor the visitor function object
     @param action_on_grey_nodes
   */  
-  template<typename GRAPHEDGE, typename VISITOR>
-  void depth_first_search(const LabeledDirectedGraph<GRAPHEDGE>& g, 
+  template<typename GRAPH, typename VISITOR>
+  void depth_first_search(const GRAPH& g, 
                           VISITOR& visitor,
                           bool action_on_grey_nodes)
   {
-    typedef detail::GraphDFSSearch<GRAPHEDGE> DFSSearch;
-    
-    DFSSearch dfs_algorithm(g,action_on_grey_nodes);
-    // Iterate over all graph nodes
-    for (auto n = g.nodes().begin(); n != g.nodes().end(); ++n) {
-      // If the node color is white, start a new search
-      if (dfs_algorithm.get_color(*n) == DFSSearch::dfsWHITE) {
-        //std::cout << "Exploring " << *n << std::endl;
-        dfs_algorithm.dfs(*n,visitor);
-      }
-    }
+    detail::GraphDFSSearch<GRAPH> dfs_algorithm(g,action_on_grey_nodes);
+    // Start a search from every node which is still white
+    dfs_algorithm.dfs_all(visitor);
+  }
+
+  /// Same as above for generic graphs with the search state allocated
+  /// from the memory resource r
+  template<typename GRAPH, typename VISITOR>
+  typename std::enable_if<!is_dense_graph<GRAPH>::value>::type
+  depth_first_search(const GRAPH& g,
+                     VISITOR& visitor,
+                     bool action_on_grey_nodes,
+                     std::pmr::memory_resource* r)
+  {
+    detail::GraphDFSSearch<GRAPH> dfs_algorithm(g,action_on_grey_nodes,r);
+    dfs_algorithm.dfs_all(visitor);
   }
 
   // We define a separate sub-namespace for the private definitions
   namespace detail {
   /**
     @brief Depth-first search class for graphs.
-           The template parameter is the type of the graph edge.
+           The template parameter is the type of the graph.
   */
-  template<typename GRAPHEDGE>
+  template<typename GRAPH, bool DENSE>
   class GraphDFSSearch
   {
   public:
-    typedef typename GRAPHEDGE::Node                      Node;
+    typedef typename GRAPH::Node                          Node;
     typedef enum { dfsWHITE, dfsGREY, dfsBLACK, dfsNONE } NodeColor;
   
   public:
@@ -80,17 +196,15 @@ namespace MyCoolGraphLibrary {
              the visitor object will be performed when a node is seen for
              the first time (when it gets grey). Otherwise, the action takes
              place when the node gets black
+      @param r the memory resource for the search state
     */
-    GraphDFSSearch(const LabeledDirectedGraph<GRAPHEDGE>& g, 
-                   bool action_when_first_discovered = true) 
-    : the_graph(g), do_action_on_grey_node(action_when_first_discovered)
+    GraphDFSSearch(const GRAPH& g, 
+                   bool action_when_first_discovered = true,
+                   std::pmr::memory_resource* r = std::pmr::get_default_resource()) 
+    : the_graph(g), colors(r), do_action_on_grey_node(action_when_first_discovered)
     {  
-      // Paint all nodes white (= not seen yet)
-      // Note: in principle, not necessary, since a node not found in
-      // the map could be interpreted as a white node
-      for (auto it = g.nodes().begin(); it != g.nodes().end(); ++it) {
-        colors[*it] = dfsWHITE;
-      }  
+      // Nodes are not painted white here: a graph node which is not in
+      // the color map is white (= not seen yet), see get_color()
     }
     
     /** 
@@ -101,8 +215,21 @@ namespace MyCoolGraphLibrary {
     template<typename VISITOR>
     void dfs(const Node& start_node, VISITOR& visitor)
     {
-      // Start the recursive function
-      dfs_rec(start_node,visitor);
+      dfs_iterative(start_node,visitor);
+    }
+
+    /// Start a search from each node of the graph which is still white
+    template<typename VISITOR>
+    void dfs_all(VISITOR& visitor)
+    {
+      // Iterate over all graph nodes
+      for (auto n = the_graph.nodes().begin(); n != the_graph.nodes().end(); ++n) {
+        // If the node color is white, start a new search
+        if (get_color(*n) == dfsWHITE) {
+          //std::cout << "Exploring " << *n << std::endl;
+          dfs_iterative(*n,visitor);
+        }
+      }
     }
 
     /** 
@@ -112,64 +239,250 @@ namespace MyCoolGraphLibrary {
     /// * WHITE = Unseen node
     /// * GREY  = Seen node, that is currently processed
     /// * BLACK = Seen node, that is finished 
-    /// * NONE  = 'Fail state'
+    /// * NONE  = 'Fail state' (not a node of the graph)
     */
     NodeColor get_color(const Node& node) const
     {
       auto it = colors.find(node);
-      return (it == colors.end() ? dfsNONE : it->second);
+      if (it != colors.end()) return it->second;
+      return (the_graph.nodes().find(node) != the_graph.nodes().end()) ? dfsWHITE : dfsNONE;
     }
   
+  private: // Types
+    typedef std::pmr::map<Node,NodeColor>       NodeColorMap;
+    typedef decltype(std::declval<const GRAPH&>()[std::declval<Node>()].begin()) EdgeIterator;
+
+    /// Stack frame of the iterative search
+    struct Frame
+    {
+      Frame(const Node& n, EdgeIterator b, EdgeIterator e) : node(n), next(b), end(e) {}
+      Node         node;   ///< A grey node
+      EdgeIterator next;   ///< Its next out-edge
+      EdgeIterator end;
+    };
+
   private:
-    /// Recursive function for DFS.
-    /// Perform a depth-first search for the given node.
+    /// Iterative DFS from node with an explicit stack, so that long paths
+    /// do not overflow the call stack. Each stack frame holds a grey node
+    /// and the position of the next out-edge to follow.
     template<typename VISITOR>
-    void dfs_rec(const Node& node, VISITOR& visitor) 
+    void dfs_iterative(const Node& node, VISITOR& visitor) 
     {
-      switch (get_color(node)) {
-        case dfsGREY:
-          // If we discover a state that we have already seen,
-          // the graph is cyclic and don't continue to avoid loops.
-          break;
-          
-        case dfsBLACK:
-          break;
-        
-        // Recursive case:
-        case dfsWHITE:
-          // First, mark the node as GREY. This is the beginning of its lifecycle.
-          colors[node] = dfsGREY;
-
-          // Call visitor
-          if (do_action_on_grey_node)
-            visitor(node);
-
-          // Continue recursion: Get all direct neighbour states
-          auto& neighbours = the_graph[node];
-
-          // Iterate over them and start the dfs again.
-          for (auto e = neighbours.begin(); e != neighbours.end(); ++e) {
-            dfs_rec(e->target(),visitor);
-          } // for e
-          
-          // Eventually, all connected nodes have been processed. 
-          // Mark it as black.
-          colors[node] = dfsBLACK;
+      // Grey and black nodes have been seen before; this also avoids
+      // loops in cyclic graphs
+      if (get_color(node) != dfsWHITE) return;
+      std::pmr::vector<Frame> stack(colors.get_allocator().resource());
+      discover(node,stack,visitor);
+
+      while (!stack.empty()) {
+        Frame& top = stack.back();
+        if (top.next == top.end) {
+          // All connected nodes have been processed. Mark it as black.
+          Node finished = top.node;
+          stack.pop_back();
+          colors[finished] = dfsBLACK;
           if (!do_action_on_grey_node)
-            visitor(node);
-          break;
-      } // switch
+            visitor(finished);
+          continue;
+        }
+        Node next = top.next->target();
+        ++top.next;
+        if (get_color(next) == dfsWHITE)
+          discover(next,stack,visitor);
+      } // while
     }
 
-  private: // Types
-    typedef std::map<Node,NodeColor>            NodeColorMap;
+    /// Marks node as GREY (the beginning of its lifecycle) and pushes it
+    template<typename VISITOR>
+    void discover(const Node& node, std::pmr::vector<Frame>& stack, VISITOR& visitor)
+    {
+      colors[node] = dfsGREY;
+      if (do_action_on_grey_node)
+        visitor(node);
+      const auto& neighbours = the_graph[node];
+      stack.push_back(Frame(node,neighbours.begin(),neighbours.end()));
+    }
 
   private: // Member variables
-    const LabeledDirectedGraph<GRAPHEDGE>& the_graph;
+    const GRAPH& the_graph;
     NodeColorMap colors; ///< Assigns a color to each node
     bool do_action_on_grey_node;
   }; // GraphDFSSearch
 
+  /**
+    @brief Depth-first search for dense graphs (e.g. CompressedGraph).
+           Same interface as the generic class, but the colors are stored
+           in a TraversalWorkspace (the caller's or one of its own) and the
+           search is run by the iterative DFSEngine.
+           All searches of one GraphDFSSearch object share the colors.
+  */
+  template<typename GRAPH>
+  class GraphDFSSearch<GRAPH,true>
+  {
+  public:
+    typedef typename GRAPH::Node                          Node;
+    typedef typename GRAPH::NodeId                        NodeId;
+    typedef typename GRAPH::EdgeIndex                     EdgeIndex;
+    typedef enum { dfsWHITE, dfsGREY, dfsBLACK, dfsNONE } NodeColor;
+  
+  public:
+    /// Constructor (see the generic version)
+    GraphDFSSearch(const GRAPH& g, 
+                   bool action_when_first_discovered = true) 
+    : the_graph(g), own_workspace(new TraversalWorkspace<GRAPH>(g)),
+      workspace(*own_workspace), engine(g,workspace),
+      do_action_on_grey_node(action_when_first_discovered)
+    {
+      workspace.start();
+    }
+
+    /// Constructor using the workspace ws of graph g; no node is painted,
+    /// starting a new search of the workspace makes all nodes white
+    GraphDFSSearch(const GRAPH& g, TraversalWorkspace<GRAPH>& ws,
+                   bool action_when_first_discovered = true) 
+    : the_graph(g), workspace(ws), engine(g,ws),
+      do_action_on_grey_node(action_when_first_discovered)
+    {
+      workspace.start();
+    }
+    
+    /// Start the depth-first search at a given node
+    template<typename VISITOR>
+    void dfs(const Node& start_node, VISITOR& visitor)
+    {
+      NodeActions<VISITOR> actions(the_graph,visitor,do_action_on_grey_node);
+      engine.visit_from(the_graph.id(start_node),actions);
+    }
+
+    /// Start a search from each node of the graph which is still white
+    template<typename VISITOR>
+    void dfs_all(VISITOR& visitor)
+    {
+      NodeActions<VISITOR> actions(the_graph,visitor,do_action_on_grey_node);
+      engine.visit_all(actions);
+    }
+
+    /// Returns the color for a node (NONE for unknown nodes)
+    NodeColor get_color(const Node& node) const
+    {
+      NodeId u = the_graph.id(node);
+      return (u == GRAPH::NoNode()) ? dfsNONE : NodeColor(workspace.color(u));
+    }
+
+  private:
+    /// Calls the node visitor when a node gets grey or black
+    template<typename VISITOR>
+    struct NodeActions : public DFSVisitor<GRAPH>
+    {
+      NodeActions(const GRAPH& g, VISITOR& v, bool on_grey)
+      : graph(g), visitor(v), action_on_grey(on_grey) {}
+
+      void discover_node(NodeId u) { if (action_on_grey) visitor(graph.node(u)); }
+      void finish_node(NodeId u)   { if (!action_on_grey) visitor(graph.node(u)); }
+
+      const GRAPH& graph;
+      VISITOR& visitor;
+      bool action_on_grey;
+    };
+
+  private: // Member variables
+    const GRAPH& the_graph;
+    std::unique_ptr< TraversalWorkspace<GRAPH> > own_workspace;
+    TraversalWorkspace<GRAPH>& workspace; ///< Holds the color of each node id
+    DFSEngine<GRAPH> engine;
+    bool do_action_on_grey_node;
+  }; // GraphDFSSearch<GRAPH,true>
+
+
+  /**
+    @brief Iterative depth-first search on dense node ids with an explicit
+           stack, so the depth of the search is not limited by the call
+           stack. Colors and the stack are kept in a TraversalWorkspace,
+           so a reused workspace makes repeated searches allocation-free;
+           each stack frame holds a grey node and the index of its next
+           out-edge.
+           The events are reported to a DFSVisitor.
+  */
+  template<typename GRAPH>
+  class DFSEngine
+  {
+  public:
+    typedef typename GRAPH::NodeId                        NodeId;
+    typedef typename GRAPH::EdgeIndex                     EdgeIndex;
+    typedef TraversalWorkspace<GRAPH>                     Workspace;
+    typedef typename Workspace::Frame                     Frame;
+
+  public:
+    /// Constructor; the caller starts the search of the workspace
+    DFSEngine(const GRAPH& g, Workspace& ws)
+    : the_graph(g), workspace(ws), stack(ws.stack())
+    {}
+
+    /// Searches from node id s if it is white; false if the visitor stopped
+    template<typename VISITOR>
+    bool visit_from(NodeId s, VISITOR& visitor)
+    {
+      if (s == GRAPH::NoNode() || workspace.color(s) != Workspace::White) return true;
+      stack.clear();
+      if (!discover(s,visitor)) return false;
+
+      while (!stack.empty()) {
+        Frame& top = stack.back();
+        NodeId u = top.first;
+        if (top.second == the_graph.last_edge(u)) {
+          stack.pop_back();
+          workspace.set_color(u,Workspace::Black);
+          visitor.finish_node(u);
+          if (visitor.stop()) return false;
+          continue;
+        }
+        EdgeIndex e = top.second++;
+        NodeId v = the_graph.target(e);
+        switch (workspace.color(v)) {
+          case Workspace::White:
+            visitor.tree_edge(u,e);
+            if (visitor.stop() || !discover(v,visitor)) return false;
+            break;
+          case Workspace::Grey:
+            visitor.back_edge(u,e);
+            if (visitor.stop()) return false;
+            break;
+          default:
+            visitor.forward_or_cross_edge(u,e);
+            if (visitor.stop()) return false;
+            break;
+        }
+      }
+      return true;
+    }
+
+    /// Searches from every white node in id order
+    template<typename VISITOR>
+    bool visit_all(VISITOR& visitor)
+    {
+      for (NodeId u = 0; u < the_graph.no_of_nodes(); ++u) {
+        if (!visit_from(u,visitor)) return false;
+      }
+      return true;
+    }
+
+  private:
+    /// Paints u grey and pushes it
+    template<typename VISITOR>
+    bool discover(NodeId u, VISITOR& visitor)
+    {
+      workspace.set_color(u,Workspace::Grey);
+      stack.push_back(Frame(u,the_graph.first_edge(u)));
+      visitor.discover_node(u);
+      return !visitor.stop();
+    }
+
+  private: // Member variables
+    const GRAPH& the_graph;
+    Workspace& workspace;
+    std::vector<Frame>& stack;  ///< The stack of the workspace
+  }; // DFSEngine
+
   } // namespace detail
 } // namespace MyCoolGraphLibrary
 
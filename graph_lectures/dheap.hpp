@@ -0,0 +1,183 @@
+////////////////////////////////////////////////////////////////////////////////
+// dheap.hpp
+// Indexed d-ary heap over dense ids with decrease-key
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DHEAP_HPP__
+#define __DHEAP_HPP__
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include <cstdint>
+
+namespace MyCoolGraphLibrary {
+
+  namespace detail {
+
+    /**
+      @brief IndexedDaryHeap is a min-heap of ids 0..n-1 with keys. Each id
+             is at most once in the heap, and a position array allows
+             decrease_key() in O(log_D n). So a Dijkstra heap never holds
+             more than n entries. A larger D makes the tree flatter and
+             the sift-down loop scan consecutive memory. Equal keys are
+             ordered by id, which makes the pop order deterministic.
+             ALLOC allocates the arrays (e.g. a polymorphic_allocator).
+    */
+    template<typename KEY, unsigned D = 4, typename ALLOC = std::allocator<KEY> >
+    class IndexedDaryHeap
+    {
+    public:
+      typedef KEY             Key;
+      typedef std::uint32_t   Index;
+      typedef ALLOC           Allocator;
+
+      static_assert(D >= 2,"a heap needs at least two children per node");
+
+    public:
+      /// Constructor for ids 0..n-1
+      explicit IndexedDaryHeap(std::size_t n = 0, const Allocator& a = Allocator())
+      : entries(a), position(n,NotInHeap(),a) {}
+
+      /// Changes the id range to 0..n-1; the heap must be empty
+      void resize(std::size_t n) { position.assign(n,NotInHeap()); }
+
+      /// Adds the id n to the range 0..n-1 and returns it, for ids which
+      /// are handed out while the search runs
+      Index add_id()
+      {
+        position.push_back(NotInHeap());
+        return Index(position.size() - 1);
+      }
+
+      bool empty() const          { return entries.empty(); }
+      std::size_t size() const    { return entries.size(); }
+      bool contains(Index v) const { return position[v] != NotInHeap(); }
+
+      /// Key of id v (v must be in the heap)
+      const Key& key(Index v) const { return entries[position[v]].first; }
+
+      /// Id and key with the smallest key
+      Index      top() const      { return entries.front().second; }
+      const Key& top_key() const  { return entries.front().first; }
+
+      /// Inserts id v (which must not be in the heap)
+      void push(Index v, const Key& k)
+      {
+        position[v] = Index(entries.size());
+        entries.push_back(Entry(k,v));
+        sift_up(entries.size() - 1);
+      }
+
+      /// Lowers the key of id v (which must be in the heap)
+      void decrease_key(Index v, const Key& k)
+      {
+        entries[position[v]].first = k;
+        sift_up(position[v]);
+      }
+
+      /// Changes the key of id v (which must be in the heap) in either
+      /// direction
+      void update(Index v, const Key& k)
+      {
+        const bool lower = k < key(v);
+        entries[position[v]].first = k;
+        if (lower) sift_up(position[v]);
+        else sift_down(position[v]);
+      }
+
+      /// Inserts v or lowers its key; returns false if k is not smaller
+      /// than the current key of v
+      bool push_or_decrease(Index v, const Key& k)
+      {
+        if (!contains(v)) {
+          push(v,k);
+          return true;
+        }
+        if (!(k < key(v))) return false;
+        decrease_key(v,k);
+        return true;
+      }
+
+      /// Removes and returns the id with the smallest key
+      Index pop()
+      {
+        Index v = entries.front().second;
+        position[v] = NotInHeap();
+        if (entries.size() > 1) {
+          entries.front() = entries.back();
+          position[entries.front().second] = 0;
+          entries.pop_back();
+          sift_down(0);
+        }
+        else {
+          entries.pop_back();
+        }
+        return v;
+      }
+
+      /// Removes all entries in O(size())
+      void clear()
+      {
+        for (auto e = entries.begin(); e != entries.end(); ++e) position[e->second] = NotInHeap();
+        entries.clear();
+      }
+
+    private:
+      typedef std::pair<Key,Index> Entry;
+      typedef typename std::allocator_traits<ALLOC>::template rebind_alloc<Entry> EntryAllocator;
+      typedef typename std::allocator_traits<ALLOC>::template rebind_alloc<Index> IndexAllocator;
+
+      inline static Index NotInHeap() { return Index(-1); }
+
+      static bool less(const Entry& a, const Entry& b)
+      {
+        return a.first < b.first || (!(b.first < a.first) && a.second < b.second);
+      }
+
+      void sift_up(std::size_t i)
+      {
+        Entry e = entries[i];
+        while (i > 0) {
+          std::size_t parent = (i - 1) / D;
+          if (!less(e,entries[parent])) break;
+          entries[i] = entries[parent];
+          position[entries[i].second] = Index(i);
+          i = parent;
+        }
+        entries[i] = e;
+        position[e.second] = Index(i);
+      }
+
+      void sift_down(std::size_t i)
+      {
+        Entry e = entries[i];
+        const std::size_t n = entries.size();
+        for (;;) {
+          std::size_t first = D * i + 1;
+          if (first >= n) break;
+          std::size_t last = (first + D < n) ? first + D : n;
+          std::size_t best = first;
+          for (std::size_t c = first + 1; c < last; ++c) {
+            if (less(entries[c],entries[best])) best = c;
+          }
+          if (!less(entries[best],e)) break;
+          entries[i] = entries[best];
+          position[entries[i].second] = Index(i);
+          i = best;
+        }
+        entries[i] = e;
+        position[e.second] = Index(i);
+      }
+
+    private:
+      std::vector<Entry,EntryAllocator> entries;    ///< The heap
+      std::vector<Index,IndexAllocator> position;   ///< Position of each id in entries
+    }; // IndexedDaryHeap
+
+  } // namespace detail
+
+} // namespace MyCoolGraphLibrary
+
+#endif
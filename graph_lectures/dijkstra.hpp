@@ -9,105 +9,505 @@
 #define __DIJKSTRA_HPP__
 
 #include <queue>
+#include <map>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <memory>
+#include <limits>
+#include <type_traits>
+#include <memory_resource>
+#include <cstdint>
 
 #include "labeledgraph.hpp"
+#include "compressedgraph.hpp"
 #include "graphtransform.hpp"
+#include "traversalworkspace.hpp"
+#include "priorityqueues.hpp"
+#include "dheap.hpp"
 
 
 
 namespace MyCoolGraphLibrary {
     
   namespace detail {
-    template<typename GRAPHEDGE> class GraphShortestPath;
+    template<typename GRAPH, bool DENSE = is_dense_graph<GRAPH>::value> 
+    class GraphShortestPath;
   }
 
   /**
-    @brief depth_first_search() implements depth-first search from a given node
+    @brief distance_search() implements Dijkstra's algorithm from a given node
+    @param g the graph to be searched
+    @param start the start node of the graph
+    @param visitor is called for each reachable node in the order of
+           increasing distance from start
   */  
-  template<typename GRAPHEDGE, typename VISITOR>
-  void distance_search(const LabeledDirectedGraph<GRAPHEDGE>& g, 
-                          const typename GRAPHEDGE::Node& start,
+  template<typename GRAPH, typename VISITOR>
+  void distance_search(const GRAPH& g, 
+                          const typename GRAPH::Node& start,
                           VISITOR& visitor)
   {
     // Instantiate the algorithm with the given graph
-    detail::GraphShortestPath<GRAPHEDGE> shortest_path_algorithm(g);
+    detail::GraphShortestPath<GRAPH> shortest_path_algorithm(g);
     // Start the search at the node
     shortest_path_algorithm.dijkstra(start,visitor);
   }
 
+  /**
+    @brief Same as above for dense graphs, but distances, predecessors,
+           settled flags and the heap are kept in a workspace which is
+           reused by later searches
+  */
+  template<typename GRAPH, typename VISITOR>
+  void distance_search(const GRAPH& g, 
+                       const typename GRAPH::Node& start,
+                       VISITOR& visitor,
+                       TraversalWorkspace<GRAPH>& workspace)
+  {
+    detail::GraphShortestPath<GRAPH> shortest_path_algorithm(g,workspace);
+    shortest_path_algorithm.dijkstra(start,visitor);
+  }
+
+  /**
+    @brief Same as the first version for generic graphs, but the distance
+           map and the heap are allocated from the memory resource r (e.g.
+           a std::pmr::monotonic_buffer_resource). Dense graphs keep their
+           state in a TraversalWorkspace instead.
+  */
+  template<typename GRAPH, typename VISITOR>
+  typename std::enable_if<!is_dense_graph<GRAPH>::value>::type
+  distance_search(const GRAPH& g,
+                  const typename GRAPH::Node& start,
+                  VISITOR& visitor,
+                  std::pmr::memory_resource* r)
+  {
+    detail::GraphShortestPath<GRAPH> shortest_path_algorithm(g,r);
+    shortest_path_algorithm.dijkstra(start,visitor);
+  }
+
+  /**
+    @brief Same as the first version for dense graphs, but with the priority
+           queue chosen by POLICY (DaryHeapPolicy<D>, DialPolicy or
+           RadixHeapPolicy) instead of default_queue_policy, e.g.
+           distance_search(g,start,visitor,DaryHeapPolicy<8>())
+  */
+  template<typename GRAPH, typename VISITOR, typename POLICY>
+  typename std::enable_if<is_queue_policy<POLICY>::value>::type
+  distance_search(const GRAPH& g,
+                  const typename GRAPH::Node& start,
+                  VISITOR& visitor, POLICY policy)
+  {
+    detail::GraphShortestPath<GRAPH> shortest_path_algorithm(g);
+    shortest_path_algorithm.dijkstra(start,visitor,policy);
+  }
+
+  /**
+    @brief ShortestPathTree holds the result of shortest_paths(): the
+           distance and the predecessor of every node id.
+  */
+  template<typename GRAPH>
+  struct ShortestPathTree
+  {
+    typedef typename GRAPH::NodeId    NodeId;
+    typedef typename GRAPH::Weight    Weight;
+    typedef typename distance_traits<Weight>::Distance Distance;
+
+    /// Distance of unreachable nodes
+    inline static Distance Infinity() { return std::numeric_limits<Distance>::max(); }
+
+    NodeId                source;       ///< The start node id
+    std::vector<Distance> distance;     ///< Distance of each node id from source
+    std::vector<NodeId>   predecessor;  ///< Previous node on a shortest path
+
+    /// Is node id v reachable from the source?
+    bool reached(NodeId v) const { return distance[v] != Infinity(); }
+
+    /// The node ids of a shortest path from the source to v (empty if v
+    /// is not reachable)
+    std::vector<NodeId> path(NodeId v) const
+    {
+      std::vector<NodeId> p;
+      if (!reached(v)) return p;
+      for (; v != GRAPH::NoNode(); v = predecessor[v]) p.push_back(v);
+      std::reverse(p.begin(),p.end());
+      return p;
+    }
+  };
+
+  /**
+    @brief shortest_paths() computes the distances from start to all
+           nodes of a dense graph and the tree of shortest paths. POLICY
+           selects the priority queue (see distance_search()).
+  */
+  template<typename GRAPH, typename POLICY = typename default_queue_policy<typename GRAPH::Weight>::type>
+  typename std::enable_if<is_dense_graph<GRAPH>::value,ShortestPathTree<GRAPH> >::type
+  shortest_paths(const GRAPH& g, const typename GRAPH::Node& start, POLICY policy = POLICY())
+  {
+    typedef ShortestPathTree<GRAPH> Tree;
+    Tree tree;
+    tree.source = g.id(start);
+    tree.distance.assign(g.no_of_nodes(),Tree::Infinity());
+    tree.predecessor.assign(g.no_of_nodes(),GRAPH::NoNode());
+    detail::GraphShortestPath<GRAPH> shortest_path_algorithm(g);
+    shortest_path_algorithm.run(tree.source,[&](typename GRAPH::NodeId v) {
+      tree.distance[v] = shortest_path_algorithm.distance(v);
+      tree.predecessor[v] = shortest_path_algorithm.predecessor(v);
+    },policy);
+    return tree;
+  }
+
+  /**
+    @brief ShortestPathMap holds the result of shortest_paths() on a
+           generic graph: the distance and the predecessor of every node
+           reachable from the source, which is its own predecessor.
+  */
+  template<typename GRAPH>
+  struct ShortestPathMap
+  {
+    typedef typename GRAPH::Node      Node;
+    typedef typename edge_traits<typename GRAPH::GraphEdge>::Weight Weight;
+    typedef typename distance_traits<Weight>::Distance Distance;
+
+    struct Entry
+    {
+      Distance distance;      ///< Distance from the source
+      Node     predecessor;   ///< Previous node on a shortest path
+    };
+
+    Node                  source;   ///< The start node
+    std::map<Node,Entry>  nodes;    ///< The reachable nodes
+
+    /// Is node v reachable from the source?
+    bool reached(const Node& v) const { return nodes.find(v) != nodes.end(); }
+
+    /// Distance of the reachable node v
+    const Distance& distance(const Node& v) const { return nodes.at(v).distance; }
+
+    /// The nodes of a shortest path from the source to v (empty if v is
+    /// not reachable)
+    std::vector<Node> path(Node v) const
+    {
+      std::vector<Node> p;
+      if (!reached(v)) return p;
+      p.push_back(v);
+      while (!(v == source)) {
+        v = nodes.at(v).predecessor;
+        p.push_back(v);
+      }
+      std::reverse(p.begin(),p.end());
+      return p;
+    }
+  };
+
+  /**
+    @brief shortest_paths() for generic graphs like LabeledDirectedGraph
+           or the views of graphview.hpp: the distances from start to all
+           reachable nodes and their shortest paths
+  */
+  template<typename GRAPH>
+  typename std::enable_if<!is_dense_graph<GRAPH>::value,ShortestPathMap<GRAPH> >::type
+  shortest_paths(const GRAPH& g, const typename GRAPH::Node& start)
+  {
+    typedef detail::GraphShortestPath<GRAPH> Search;
+    ShortestPathMap<GRAPH> result;
+    result.source = start;
+    Search search(g);
+    search.run(start,[&](typename Search::Index u) {
+      typename Search::Index p = search.predecessor(u);
+      result.nodes.emplace(search.node(u),typename ShortestPathMap<GRAPH>::Entry{
+        search.distance(u),search.node(p == Search::NoIndex() ? u : p)});
+    });
+    return result;
+  }
+
   namespace detail {
     
-    template<typename GRAPHEDGE>
+    /**
+      @brief Dijkstra for generic graphs. A node gets a local id when it is
+             first reached (a map from nodes to ids); distances,
+             predecessors and settled flags are arrays over these ids, and
+             the heap is an IndexedDaryHeap with decrease-key. So the heap
+             holds at most one entry per node and a node is copied only
+             once, into the id map, not on every relaxation. Equal
+             distances are settled in the order of the nodes, like in the
+             dense version. All state comes from the memory resource.
+    */
+    template<typename GRAPH, bool DENSE>
     class GraphShortestPath
     {
     public:
-      typedef unsigned int                                  Weight;
-      typedef typename GRAPHEDGE::Node                      Node;
+      typedef typename edge_traits<typename GRAPH::GraphEdge>::Weight Weight;
+      typedef typename distance_traits<Weight>::Distance    Distance;
+      typedef typename GRAPH::Node                          Node;
+      typedef std::uint32_t                                 Index;
+
+      /// Predecessor of the start node
+      inline static Index NoIndex() { return Index(-1); }
 
-    private:
-      struct DijkstraComp {
-        typedef std::pair<GRAPHEDGE,Weight> NodeDist;
-        
-        bool operator() (const NodeDist& lhs, const NodeDist& rhs) const
-        {
-          return (lhs.second < rhs.second);
-        }
-      };
     public:
       /** 
         @brief Constructor
         @param g the graph
-        @param action_when_first_discovered when true, the action defined by
-               the visitor object will be performed when a node is seen for
-               the first time (when it gets grey). Otherwise, the action takes
-               place when the node gets black
+        @param r the memory resource for the search state
       */
-      GraphShortestPath(const LabeledDirectedGraph<GRAPHEDGE>& g) 
-      : graph(g)
+      GraphShortestPath(const GRAPH& g,
+                        std::pmr::memory_resource* r = std::pmr::get_default_resource()) 
+      : graph(g), ids(r), nodes(r), distances(r), predecessors(r), settled_flags(r),
+        heap(0,std::pmr::polymorphic_allocator<HeapKey>(r))
       {}
 
+      /// Calls the visitor for each node reachable from start_node in
+      /// the order of increasing distance
       template<typename VISITOR>
       void dijkstra(const Node& start_node, VISITOR& visitor)
       {
-        NodeDist tmpDist;
-        
-        visitor(start_node);
-        distances[start_node] = 0;
-        auto& neighbours = graph[start_node];
-        for(auto e = neighbours.begin(); e != neighbours.end(); ++e) {
-          distHeap.emplace(NodeDist(*e,e->weight()));
-        }
+        run(start_node,[&](Index u) { visitor(node(u)); });
+      }
+
+      /// Runs the search from start_node and calls settled(u) for the
+      /// local id u of each node when its distance is final
+      template<typename SETTLED>
+      void run(const Node& start_node, SETTLED settled)
+      {
+        clear();
+        Index s = reach(ids.end(),start_node,Distance(),NoIndex());
+        heap.push(s,HeapKey(Distance(),nodes[s]));
 
-        while(!distHeap.empty()) {
-          tmpDist = distHeap.top();
-          distHeap.pop();
+        while (!heap.empty()) {
+          Index u = heap.pop();
+          settled_flags[u] = 1;
+          settled(u);
 
-          if(distances.find(tmpDist.first.target()) != distances.end()) {
-            // We already have this node in the distance map
-            continue;
+          const Distance du = distances[u];
+          const auto& nextNodes = graph[node(u)];
+          for (auto e = nextNodes.begin(); e != nextNodes.end(); ++e) {
+            Distance dv = du + Distance(edge_weight(*e));
+            auto it = ids.lower_bound(e->target());
+            if (it == ids.end() || ids.key_comp()(e->target(),it->first)) {
+              // First time seen
+              Index v = reach(it,e->target(),dv,u);
+              heap.push(v,HeapKey(dv,nodes[v]));
+            }
+            else {
+              Index v = it->second;
+              if (!settled_flags[v] && dv < distances[v]) {
+                distances[v] = dv;
+                predecessors[v] = u;
+                heap.decrease_key(v,HeapKey(dv,nodes[v]));
+              }
+            }
           }
-          visitor(tmpDist.first.target());
-          distances[tmpDist.first.target()] = tmpDist.second;
-          
+        }
+      }
 
-          auto& nextNodes = graph[tmpDist.first.target()];
-          for(auto e = nextNodes.begin(); e != nextNodes.end(); ++e) {
-            distHeap.emplace(NodeDist(*e,tmpDist.second + e->weight()));
-          }
+      /// Number of nodes reached by the last search
+      Index size() const { return Index(nodes.size()); }
+
+      /// Node, distance and predecessor (NoIndex() for the start node) of
+      /// local id u in the last search
+      const Node& node(Index u) const { return *nodes[u]; }
+      const Distance& distance(Index u) const { return distances[u]; }
+      Index predecessor(Index u) const { return predecessors[u]; }
+
+    private:
+      /// Heap key: the distance, ties broken by the node
+      struct HeapKey
+      {
+        HeapKey(const Distance& d = Distance(), const Node* n = 0) : dist(d), node(n) {}
+
+        bool operator<(const HeapKey& k) const
+        {
+          return dist < k.dist || (!(k.dist < dist) && *node < *k.node);
         }
+
+        Distance    dist;
+        const Node* node;   ///< The key in the id map
+      };
+
+      typedef std::pmr::map<Node,Index> IdMap;
+      typedef IndexedDaryHeap<HeapKey,4,std::pmr::polymorphic_allocator<HeapKey> > DistanceHeap;
+
+      /// Gives node n (not in the map, which has position hint) the next
+      /// local id, with distance d and predecessor p
+      Index reach(typename IdMap::iterator hint, const Node& n, const Distance& d, Index p)
+      {
+        Index v = heap.add_id();
+        auto it = ids.emplace_hint(hint,n,v);
+        nodes.push_back(&it->first);
+        distances.push_back(d);
+        predecessors.push_back(p);
+        settled_flags.push_back(0);
+        return v;
       }
 
+      /// Forgets the last search
+      void clear()
+      {
+        heap.clear();
+        heap.resize(0);
+        ids.clear();
+        nodes.clear();
+        distances.clear();
+        predecessors.clear();
+        settled_flags.clear();
+      }
+
+      const GRAPH& graph;
+      IdMap ids;                                  ///< Local id of each node reached
+      std::pmr::vector<const Node*> nodes;        ///< Node of each local id
+      std::pmr::vector<Distance> distances;       ///< Distance of each local id
+      std::pmr::vector<Index> predecessors;       ///< Predecessor of each local id
+      std::pmr::vector<unsigned char> settled_flags;
+      DistanceHeap heap;
+    };
+
+    /**
+      @brief Dijkstra for dense graphs (e.g. CompressedGraph).
+             Distances, predecessors and settled flags (black nodes) are kept
+             in a TraversalWorkspace indexed by node id. The priority queue
+             is the workspace heap (the default queue for the weight type)
+             or a queue of the policy passed to run(); all queues support
+             decrease-key on node ids.
+    */
+    template<typename GRAPH>
+    class GraphShortestPath<GRAPH,true>
+    {
+    public:
+      typedef typename GRAPH::Weight                        Weight;
+      typedef typename distance_traits<Weight>::Distance    Distance;
+      typedef typename GRAPH::Node                          Node;
+      typedef typename GRAPH::NodeId                        NodeId;
+      typedef typename GRAPH::EdgeIndex                     EdgeIndex;
+
+    public:
+      /// Constructor
+      GraphShortestPath(const GRAPH& g) 
+      : graph(g), own_workspace(new TraversalWorkspace<GRAPH>(g)),
+        workspace(*own_workspace)
+      {}
+
+      /// Constructor using the workspace ws of graph g
+      GraphShortestPath(const GRAPH& g, TraversalWorkspace<GRAPH>& ws) 
+      : graph(g), workspace(ws)
+      {}
+
+      /// Calls the visitor for each node reachable from start_node in
+      /// the order of increasing distance
+      template<typename VISITOR>
+      void dijkstra(const Node& start_node, VISITOR& visitor)
+      {
+        NodeId s = graph.id(start_node);
+        if (s == GRAPH::NoNode()) {
+          visitor(start_node);
+          return;
+        }
+        run(s,[&](NodeId u) { visitor(graph.node(u)); });
+      }
+
+      /// Same as above with a priority queue of the given policy
+      template<typename VISITOR, typename POLICY>
+      void dijkstra(const Node& start_node, VISITOR& visitor, POLICY policy)
+      {
+        NodeId s = graph.id(start_node);
+        if (s == GRAPH::NoNode()) {
+          visitor(start_node);
+          return;
+        }
+        run(s,[&](NodeId u) { visitor(graph.node(u)); },policy);
+      }
+
+      /// Runs the search from node id s and calls settled(u) for each
+      /// node id u when its distance is final
+      template<typename SETTLED>
+      void run(NodeId s, SETTLED settled)
+      {
+        workspace.start();
+        search(s,[&](NodeId u) { settled(u); return true; },workspace.heap());
+      }
+
+      /// Same as above, but the search stops as soon as settled(u)
+      /// returns false
+      template<typename SETTLED>
+      void run_until(NodeId s, SETTLED settled)
+      {
+        workspace.start();
+        search(s,settled,workspace.heap());
+      }
+
+      /// Same as above with a priority queue of the given policy
+      template<typename SETTLED, typename POLICY>
+      void run(NodeId s, SETTLED settled, POLICY policy)
+      {
+        typedef typename POLICY::template queue<Distance>::type Queue;
+        run_with(s,settled,policy,std::is_same<Queue,typename Workspace::Heap>());
+      }
+
+      /// Distance and predecessor of node id v in the last search
+      const Distance& distance(NodeId v) const { return workspace.distance(v); }
+      NodeId predecessor(NodeId v) const { return workspace.predecessor(v); }
+
+      /// Was node id v settled in the last search?
+      bool settled(NodeId v) const { return workspace.color(v) == Workspace::Black; }
+
     private:
-      typedef std::map<Node,Weight> DistanceMap;
-      typedef std::pair<GRAPHEDGE,Weight> NodeDist;
-      typedef std::priority_queue<NodeDist, std::vector<NodeDist>, DijkstraComp> DistanceHeap; 
-      
-      const LabeledDirectedGraph<GRAPHEDGE>& graph;
-      DistanceMap distances;
-      DistanceHeap distHeap;
+      typedef TraversalWorkspace<GRAPH>       Workspace;
+
+      /// The policy queue is the workspace heap
+      template<typename SETTLED, typename POLICY>
+      void run_with(NodeId s, SETTLED& settled, POLICY, std::true_type)
+      {
+        run(s,settled);
+      }
+
+      /// Other policies get a queue of their own
+      template<typename SETTLED, typename POLICY>
+      void run_with(NodeId s, SETTLED& settled, POLICY, std::false_type)
+      {
+        typedef typename POLICY::template queue<Distance>::type Queue;
+        Queue queue(graph.no_of_nodes(),max_edge_weight(graph));
+        workspace.start();
+        search(s,[&](NodeId u) { settled(u); return true; },queue);
+      }
+
+      /// Dijkstra's algorithm from s with the (empty) queue heap; stops
+      /// when settled(u) returns false
+      template<typename SETTLED, typename QUEUE>
+      void search(NodeId s, SETTLED settled, QUEUE& heap)
+      {
+        if (s == GRAPH::NoNode()) return;
+        workspace.set_distance(s,Distance());
+        heap.push(s,Distance());
+
+        while (!heap.empty()) {
+          NodeId u = heap.pop();
+          Distance du = workspace.distance(u);
+          workspace.set_color(u,Workspace::Black);
+          if (!settled(u)) return;
+
+          for (EdgeIndex e = graph.first_edge(u); e != graph.last_edge(u); ++e) {
+            NodeId v = graph.target(e);
+            Distance dv = du + Distance(graph.weight(e));
+            if (!workspace.visited(v)) {
+              // First time seen: grey, in the heap
+              workspace.set_color(v,Workspace::Grey);
+              workspace.set_distance(v,dv);
+              workspace.set_predecessor(v,u);
+              heap.push(v,dv);
+            }
+            else if (workspace.color(v) == Workspace::Grey && dv < workspace.distance(v)) {
+              workspace.set_distance(v,dv);
+              workspace.set_predecessor(v,u);
+              heap.decrease_key(v,dv);
+            }
+          }
+        }
+      }
+
+      const GRAPH& graph;
+      std::unique_ptr<Workspace> own_workspace;
+      Workspace& workspace;
     };
   }
 }
 
 #endif
-
@@ -0,0 +1,146 @@
+////////////////////////////////////////////////////////////////////////////////
+// distancetable.hpp
+// Many-to-many distance tables with parallel Dijkstra searches
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DISTANCETABLE_HPP__
+#define __DISTANCETABLE_HPP__
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <limits>
+#include <cstdint>
+
+#include "compressedgraph.hpp"
+#include "dijkstra.hpp"
+#include "parallel.hpp"
+
+namespace MyCoolGraphLibrary {
+
+  namespace detail {
+    template<typename GRAPH> class DistanceTable;
+  }
+
+  /**
+    @brief distance_table() computes the distances from every source to
+           every target of a dense graph with non-negative weights on the
+           threads of pool. There is one Dijkstra search per source; the
+           threads take the sources one by one, and each thread keeps its
+           workspace (distances, colors, heap) for all of its searches. A
+           search stops as soon as all targets are settled, so near targets
+           make the table cheap even on a large graph.
+    @param g the graph (a dense graph like CompressedGraph)
+    @param sources the source nodes (rows)
+    @param targets the target nodes (columns)
+    @param pool the worker threads
+    @return row-major matrix of sources.size() rows of targets.size()
+            distances; the largest value of the distance type where the
+            target is not reachable
+  */
+  template<typename GRAPH>
+  std::vector<typename distance_traits<typename GRAPH::Weight>::Distance>
+  distance_table(const GRAPH& g,
+                 const std::vector<typename GRAPH::Node>& sources,
+                 const std::vector<typename GRAPH::Node>& targets,
+                 ThreadPool& pool)
+  {
+    detail::DistanceTable<GRAPH> table_algorithm(g,pool);
+    return table_algorithm.run(sources,targets);
+  }
+
+  /// Same as above, with a temporary pool of nthreads threads
+  template<typename GRAPH>
+  std::vector<typename distance_traits<typename GRAPH::Weight>::Distance>
+  distance_table(const GRAPH& g,
+                 const std::vector<typename GRAPH::Node>& sources,
+                 const std::vector<typename GRAPH::Node>& targets,
+                 unsigned nthreads = detail::default_concurrency())
+  {
+    ThreadPool pool(nthreads);
+    return distance_table(g,sources,targets,pool);
+  }
+
+  namespace detail {
+  /**
+    @brief Rows of a distance table, one Dijkstra search each. The targets
+           are marked in an array shared by all threads (read only during
+           the searches); a search counts the distinct targets it settles
+           and stops when none is left. Each thread writes only the rows of
+           its own sources.
+  */
+  template<typename GRAPH>
+  class DistanceTable
+  {
+  public:
+    typedef typename GRAPH::Node        Node;
+    typedef typename GRAPH::NodeId      NodeId;
+    typedef typename distance_traits<typename GRAPH::Weight>::Distance Distance;
+
+  public:
+    /// Constructor
+    DistanceTable(const GRAPH& g, ThreadPool& pool)
+    : graph(g), threads(pool), searches(pool.size())
+    {}
+
+    /// Table of the distances from sources to targets
+    std::vector<Distance> run(const std::vector<Node>& sources, const std::vector<Node>& targets)
+    {
+      const std::size_t columns = targets.size();
+      std::vector<Distance> table(sources.size() * columns,Infinity());
+
+      // Mark the targets; duplicates count once
+      std::vector<NodeId> target_ids(columns);
+      std::vector<unsigned char> is_target(graph.no_of_nodes(),0);
+      std::size_t distinct = 0;
+      for (std::size_t j = 0; j < columns; ++j) {
+        target_ids[j] = graph.id(targets[j]);
+        if (target_ids[j] != GRAPH::NoNode() && !is_target[target_ids[j]]) {
+          is_target[target_ids[j]] = 1;
+          ++distinct;
+        }
+      }
+      if (distinct == 0) return table;
+
+      std::atomic<std::size_t> next(0);
+      threads.run([&](unsigned t) {
+        for (;;) {
+          std::size_t i = next.fetch_add(1,std::memory_order_relaxed);
+          if (i >= sources.size()) break;
+          NodeId s = graph.id(sources[i]);
+          if (s == GRAPH::NoNode()) continue;
+          // The workspace is allocated by the thread which uses it
+          if (!searches[t]) searches[t].reset(new Search(graph));
+          Search& search = *searches[t];
+
+          std::size_t remaining = distinct;
+          search.run_until(s,[&](NodeId u) {
+            return !(is_target[u] && --remaining == 0);
+          });
+          // If the search ran out of nodes, unsettled targets are unreachable
+          Distance* row = &table[i * columns];
+          for (std::size_t j = 0; j < columns; ++j) {
+            NodeId v = target_ids[j];
+            if (v != GRAPH::NoNode() && search.settled(v)) row[j] = search.distance(v);
+          }
+        }
+      });
+      return table;
+    }
+
+  private:
+    typedef GraphShortestPath<GRAPH,true> Search;
+
+    inline static Distance Infinity() { return std::numeric_limits<Distance>::max(); }
+
+  private: // Member variables
+    const GRAPH& graph;
+    ThreadPool& threads;
+    std::vector< std::unique_ptr<Search> > searches;   ///< Search state per thread
+  }; // DistanceTable
+
+  } // namespace detail
+} // namespace MyCoolGraphLibrary
+
+#endif
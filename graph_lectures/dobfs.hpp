@@ -0,0 +1,205 @@
+////////////////////////////////////////////////////////////////////////////////
+// dobfs.hpp
+// Direction-optimizing breadth-first search on dense graphs
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DOBFS_HPP__
+#define __DOBFS_HPP__
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "compressedgraph.hpp"
+#include "reverse.hpp"
+#include "bitmap.hpp"
+
+namespace MyCoolGraphLibrary {
+
+  namespace detail {
+    template<typename GRAPH> class DirectionOptimizingBFS;
+  }
+
+  /**
+    @brief bfs_levels() computes the BFS level (distance in edges) of every
+           node from start with direction-optimizing BFS.
+    @param g the graph (a dense graph like CompressedGraph)
+    @param g_rev the reverse graph of g (see graph_reverse()), which
+           provides the in-edges for bottom-up steps
+    @param start the start node
+    @return the level of each node id; std::uint32_t(-1) for unreachable nodes
+  */
+  template<typename GRAPH>
+  std::vector<std::uint32_t> bfs_levels(const GRAPH& g, const GRAPH& g_rev,
+                                        const typename GRAPH::Node& start)
+  {
+    detail::DirectionOptimizingBFS<GRAPH> bfs_algorithm(g,g_rev);
+    bfs_algorithm.search(g.id(start));
+    return bfs_algorithm.levels();
+  }
+
+  /// Same as above, but builds the reverse graph itself
+  template<typename GRAPH>
+  std::vector<std::uint32_t> bfs_levels(const GRAPH& g, const typename GRAPH::Node& start)
+  {
+    GRAPH g_rev = graph_reverse(g);
+    return bfs_levels(g,g_rev,start);
+  }
+
+  namespace detail {
+  /**
+    @brief Direction-optimizing BFS (Beamer et al.) on dense node ids.
+           Each level is expanded either top-down (the frontier nodes look
+           at their out-edges) or bottom-up (each unvisited node looks at
+           its in-edges until it finds a parent in the frontier). Bottom-up
+           is used while the frontier is large compared to the unexplored
+           part of the graph; this saves most edge checks on graphs with a
+           small diameter. The frontier is a queue of ids in top-down steps
+           and a bitmap in bottom-up steps.
+  */
+  template<typename GRAPH>
+  class DirectionOptimizingBFS
+  {
+  public:
+    typedef typename GRAPH::NodeId      NodeId;
+    typedef typename GRAPH::EdgeIndex   EdgeIndex;
+    typedef std::uint32_t               Level;
+
+  public: // Static functions
+    inline static Level NoLevel() { return Level(-1); }
+
+  public:
+    /**
+      @brief Constructor
+      @param g the graph
+      @param g_rev the reverse graph
+      @param alpha switch to bottom-up when the frontier has more than
+             1/alpha of the unexplored edges
+      @param beta switch back to top-down when the frontier has fewer than
+             1/beta of the nodes
+    */
+    DirectionOptimizingBFS(const GRAPH& g, const GRAPH& g_rev,
+                           unsigned alpha = 15, unsigned beta = 18)
+    : graph(g), rev_graph(g_rev), alpha(alpha), beta(beta),
+      examined(0), bottom_up_steps(0)
+    {}
+
+    /// Runs the search from node id s (NoNode() gives an empty result)
+    const std::vector<Level>& search(NodeId s)
+    {
+      const NodeId n = graph.no_of_nodes();
+      level.assign(n,NoLevel());
+      examined = 0;
+      bottom_up_steps = 0;
+      if (s == GRAPH::NoNode()) return level;
+
+      std::vector<NodeId> queue(1,s), next_queue;
+      level[s] = 0;
+      Level depth = 0;
+      // Out-edges of the frontier and of the still unexplored nodes
+      EdgeIndex scout = graph.out_degree(s);
+      EdgeIndex edges_to_check = graph.no_of_edges();
+
+      while (!queue.empty()) {
+        if (scout > edges_to_check / alpha) {
+          // Bottom-up phase: continue until the frontier gets small again
+          Bitmap front(n), next(n);
+          for (auto u = queue.begin(); u != queue.end(); ++u) front.set(*u);
+          std::size_t awake = queue.size(), old_awake;
+          do {
+            old_awake = awake;
+            awake = bottom_up_step(front,next,depth);
+            front.swap(next);
+            ++depth;
+            ++bottom_up_steps;
+          } while (awake >= old_awake || awake > n / beta);
+          bitmap_to_queue(front,queue);
+          scout = 1;
+        }
+        else {
+          edges_to_check -= std::min(scout,edges_to_check);
+          scout = top_down_step(queue,next_queue,depth);
+          queue.swap(next_queue);
+          ++depth;
+        }
+      }
+      return level;
+    }
+
+    /// The levels of the last search
+    const std::vector<Level>& levels() const { return level; }
+
+    /// Number of edges looked at in the last search
+    std::uint64_t edges_examined() const { return examined; }
+
+    /// Number of levels expanded bottom-up in the last search
+    unsigned bottom_up_levels() const { return bottom_up_steps; }
+
+  private:
+    /// Expands the frontier queue along out-edges. Returns the number of
+    /// out-edges of the new frontier.
+    EdgeIndex top_down_step(const std::vector<NodeId>& queue,
+                            std::vector<NodeId>& next_queue, Level depth)
+    {
+      EdgeIndex scout = 0;
+      next_queue.clear();
+      for (auto u = queue.begin(); u != queue.end(); ++u) {
+        for (EdgeIndex e = graph.first_edge(*u); e != graph.last_edge(*u); ++e) {
+          NodeId v = graph.target(e);
+          if (level[v] == NoLevel()) {
+            level[v] = depth + 1;
+            next_queue.push_back(v);
+            scout += graph.out_degree(v);
+          }
+        }
+        examined += graph.out_degree(*u);
+      }
+      return scout;
+    }
+
+    /// Each unvisited node searches its in-edges for a frontier node.
+    /// Returns the size of the new frontier.
+    std::size_t bottom_up_step(const Bitmap& front, Bitmap& next, Level depth)
+    {
+      std::size_t awake = 0;
+      next.clear();
+      for (NodeId v = 0; v < graph.no_of_nodes(); ++v) {
+        if (level[v] != NoLevel()) continue;
+        for (EdgeIndex e = rev_graph.first_edge(v); e != rev_graph.last_edge(v); ++e) {
+          ++examined;
+          if (front.test(rev_graph.target(e))) {
+            level[v] = depth + 1;
+            next.set(v);
+            ++awake;
+            break;
+          }
+        }
+      }
+      return awake;
+    }
+
+    /// Converts a bitmap frontier into a queue
+    static void bitmap_to_queue(const Bitmap& front, std::vector<NodeId>& queue)
+    {
+      queue.clear();
+      for (std::size_t w = 0; w < front.no_of_words(); ++w) {
+        for (Bitmap::Word bits = front.word(w); bits != 0; bits &= bits - 1) {
+          queue.push_back(NodeId(w * 64 + __builtin_ctzll(bits)));
+        }
+      }
+    }
+
+  private: // Member variables
+    const GRAPH& graph;
+    const GRAPH& rev_graph;
+    unsigned alpha, beta;
+    std::vector<Level> level;     ///< BFS level of each node id
+    std::uint64_t examined;       ///< Edges examined in the last search
+    unsigned bottom_up_steps;     ///< Levels expanded bottom-up
+  }; // DirectionOptimizingBFS
+
+  } // namespace detail
+} // namespace MyCoolGraphLibrary
+
+#endif
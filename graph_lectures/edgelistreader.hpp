@@ -0,0 +1,270 @@
+////////////////////////////////////////////////////////////////////////////////
+// edgelistreader.hpp
+// Streaming reader for TSV/CSV edge lists
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __EDGELISTREADER_HPP__
+#define __EDGELISTREADER_HPP__
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <istream>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <charconv>
+#include <cstring>
+
+#include "graphtraits.hpp"
+#include "stringdictionary.hpp"
+#include "graphbuilder.hpp"
+#include "filemapping.hpp"
+#include "parallel.hpp"
+
+namespace MyCoolGraphLibrary {
+
+  namespace detail {
+    /// Builds a weighted edge, using the default weight if none was given
+    template<typename GRAPHEDGE, typename WEIGHT>
+    GRAPHEDGE make_edge(const typename GRAPHEDGE::Node& s, const typename GRAPHEDGE::Label& l,
+                        const typename GRAPHEDGE::Node& t, const WEIGHT& w, bool has_w,
+                        std::true_type)
+    {
+      return has_w ? GRAPHEDGE(s,l,t,w) : GRAPHEDGE(s,l,t);
+    }
+
+    /// Builds an unweighted edge; a weight column is ignored
+    template<typename GRAPHEDGE, typename WEIGHT>
+    GRAPHEDGE make_edge(const typename GRAPHEDGE::Node& s, const typename GRAPHEDGE::Label& l,
+                        const typename GRAPHEDGE::Node& t, const WEIGHT&, bool,
+                        std::false_type)
+    {
+      return GRAPHEDGE(s,l,t);
+    }
+  } // namespace detail
+
+  /**
+    @brief EdgeListReader reads edge lists with one edge per line:
+             source <sep> label <sep> target [<sep> weight]
+           (tab-separated by default, pass ',' for CSV; fields are not
+           quoted). Empty lines and lines starting with '#' are ignored,
+           malformed lines are skipped and counted.
+           The input is read in large chunks (or mapped), fields are
+           tokenized in place without allocating, node and label strings
+           are interned in a StringDictionary and the edges are passed on
+           to a GraphBuilder. Apart from the dictionary and the collected
+           edges, memory use does not depend on the input size.
+           GRAPHEDGE must have StringDictionary handles as nodes and labels.
+  */
+  template<typename GRAPHEDGE>
+  class EdgeListReader
+  {
+  public: // Types
+    typedef GRAPHEDGE                                   GraphEdge;
+    typedef StringDictionary::Handle                    Handle;
+    typedef typename edge_traits<GraphEdge>::Weight     Weight;
+
+    static_assert(std::is_same<typename GraphEdge::Node,Handle>::value &&
+                  std::is_same<typename GraphEdge::Label,Handle>::value,
+                  "EdgeListReader needs edges over StringDictionary handles");
+
+  public:
+    /**
+      @brief Constructor
+      @param dict the dictionary for node and label strings
+      @param builder receives the edges
+      @param separator the field separator
+      @param buffer_size size of the read buffer in bytes
+    */
+    EdgeListReader(StringDictionary& dict, GraphBuilder<GraphEdge>& builder,
+                   char separator = '\t', std::size_t buffer_size = 1 << 24)
+    : m_dict(dict), m_builder(builder), m_separator(separator),
+      m_buffer_size(buffer_size > 0 ? buffer_size : 1), m_skipped(0)
+    {}
+
+    /// Reads all edges from stream in; returns the number of edges read
+    std::size_t read(std::istream& in)
+    {
+      std::vector<char> buffer(m_buffer_size);
+      std::size_t filled = 0, edges = 0;
+      BuilderSink sink(m_builder);
+
+      for (;;) {
+        in.read(&buffer[filled],buffer.size() - filled);
+        filled += in.gcount();
+        bool at_eof = !in;
+        const char* b = buffer.data();
+        const char* rest = parse(b,b + filled,at_eof,m_dict,sink,edges);
+        if (at_eof) break;
+        // Move the incomplete last line to the front
+        std::size_t kept = b + filled - rest;
+        std::memmove(buffer.data(),rest,kept);
+        filled = kept;
+        // A line longer than the buffer: make room for it
+        if (filled == buffer.size())
+          buffer.resize(2 * buffer.size());
+      }
+      return edges;
+    }
+
+    /// Reads all edges from file path; returns the number of edges read
+    std::size_t read_file(const std::string& path)
+    {
+      std::ifstream in(path.c_str(),std::ios::binary);
+      if (!in)
+        throw std::runtime_error("cannot open " + path);
+      return read(in);
+    }
+
+    /**
+      @brief Reads file path on nthreads threads. The mapped file is split
+             into byte ranges at line boundaries, each thread parses one
+             range into its own dictionary, and the results are merged in
+             file order. So handles and edge order are the same as with
+             read_file(). Returns the number of edges read.
+    */
+    std::size_t read_file_parallel(const std::string& path,
+                                   unsigned nthreads = detail::default_concurrency())
+    {
+      detail::FileMapping mapping(path);
+      const char* data = reinterpret_cast<const char*>(mapping.data());
+      std::size_t size = mapping.size();
+      if (nthreads < 1) nthreads = 1;
+
+      // Range boundaries, moved behind the next line end
+      std::vector<std::size_t> bounds(nthreads+1,size);
+      bounds[0] = 0;
+      for (unsigned t = 1; t < nthreads; ++t) {
+        std::size_t pos = std::max(detail::chunk_begin(size,t,nthreads),bounds[t-1]);
+        const void* nl = (pos < size) ? std::memchr(data + pos,'\n',size - pos) : 0;
+        bounds[t] = nl ? static_cast<const char*>(nl) - data + 1 : size;
+      }
+
+      std::vector<StringDictionary> dicts(nthreads);
+      std::vector< std::vector<GraphEdge> > edges(nthreads);
+      std::vector<std::size_t> counts(nthreads,0), skipped(nthreads,0);
+      detail::parallel_for(nthreads,nthreads,[&](std::size_t b, std::size_t e, unsigned) {
+        for (std::size_t t = b; t < e; ++t) {
+          VectorSink sink(edges[t]);
+          EdgeListReader local(*this);
+          local.m_skipped = 0;
+          local.parse(data + bounds[t],data + bounds[t+1],true,dicts[t],sink,counts[t]);
+          skipped[t] = local.m_skipped;
+        }
+      });
+
+      // Merge the dictionaries in file order. Local handles were given out
+      // in order of first occurrence, so the global ones are too.
+      std::vector< std::vector<Handle> > remap(nthreads);
+      for (unsigned t = 0; t < nthreads; ++t) {
+        remap[t].resize(dicts[t].size());
+        for (Handle h = 0; h < dicts[t].size(); ++h) {
+          remap[t][h] = m_dict.intern(dicts[t].str(h));
+        }
+        dicts[t] = StringDictionary();
+      }
+
+      std::size_t total = 0;
+      for (unsigned t = 0; t < nthreads; ++t) total += counts[t];
+      m_builder.reserve(m_builder.size() + total);
+      for (unsigned t = 0; t < nthreads; ++t) {
+        const std::vector<Handle>& r = remap[t];
+        for (auto e = edges[t].begin(); e != edges[t].end(); ++e) {
+          m_builder.add(detail::make_edge<GraphEdge>(r[e->source()],r[e->label()],r[e->target()],
+                        edge_weight(*e),true,has_weight()));
+        }
+        std::vector<GraphEdge>().swap(edges[t]);
+        m_skipped += skipped[t];
+      }
+      return total;
+    }
+
+    /// Number of malformed lines skipped so far
+    std::size_t skipped() const { return m_skipped; }
+
+  private: // Types
+    typedef std::integral_constant<bool,edge_traits<GraphEdge>::has_weight> has_weight;
+
+    /// Passes edges on to the builder
+    struct BuilderSink
+    {
+      BuilderSink(GraphBuilder<GraphEdge>& b) : builder(b) {}
+      void operator()(GraphEdge&& e) { builder.add(std::move(e)); }
+      GraphBuilder<GraphEdge>& builder;
+    };
+
+    /// Collects edges in a vector
+    struct VectorSink
+    {
+      VectorSink(std::vector<GraphEdge>& v) : edges(v) {}
+      void operator()(GraphEdge&& e) { edges.push_back(std::move(e)); }
+      std::vector<GraphEdge>& edges;
+    };
+
+  private: // Functions
+    /**
+      @brief Parses the lines in [b,e). If at_eof is false, the last
+             (incomplete) line is left alone and its start is returned.
+    */
+    template<typename SINK>
+    const char* parse(const char* b, const char* e, bool at_eof,
+                      StringDictionary& dict, SINK& sink, std::size_t& edges)
+    {
+      while (b < e) {
+        const char* nl = static_cast<const char*>(std::memchr(b,'\n',e - b));
+        if (!nl && !at_eof) return b;
+        const char* line_end = nl ? nl : e;
+        parse_line(b,line_end,dict,sink,edges);
+        b = nl ? nl + 1 : e;
+      }
+      return e;
+    }
+
+    /// Parses one line (without the '\n')
+    template<typename SINK>
+    void parse_line(const char* b, const char* e, StringDictionary& dict,
+                    SINK& sink, std::size_t& edges)
+    {
+      if (e > b && e[-1] == '\r') --e;
+      if (b == e || *b == '#') return;
+
+      std::string_view fields[4];
+      unsigned n = 0;
+      for (const char* f = b; n < 4; ) {
+        const char* sep = static_cast<const char*>(std::memchr(f,m_separator,e - f));
+        fields[n++] = std::string_view(f,(sep ? sep : e) - f);
+        if (!sep) break;
+        f = sep + 1;
+      }
+      if (n < 3) {
+        ++m_skipped;
+        return;
+      }
+      Weight w = Weight();
+      if (n == 4) {
+        auto res = std::from_chars(fields[3].data(),fields[3].data() + fields[3].size(),w);
+        if (res.ec != std::errc() || res.ptr != fields[3].data() + fields[3].size()) {
+          ++m_skipped;
+          return;
+        }
+      }
+      Handle s = dict.intern(fields[0]);
+      Handle l = dict.intern(fields[1]);
+      Handle t = dict.intern(fields[2]);
+      sink(detail::make_edge<GraphEdge>(s,l,t,w,n == 4,has_weight()));
+      ++edges;
+    }
+
+  private:
+    StringDictionary&         m_dict;        ///< Dictionary for nodes and labels
+    GraphBuilder<GraphEdge>&  m_builder;     ///< Receives the edges
+    char                      m_separator;   ///< Field separator
+    std::size_t               m_buffer_size; ///< Size of the read buffer
+    std::size_t               m_skipped;     ///< Number of malformed lines
+  }; // EdgeListReader
+
+} // namespace MyCoolGraphLibrary
+
+#endif
@@ -0,0 +1,172 @@
+////////////////////////////////////////////////////////////////////////////////
+// edgestorage.hpp
+// Storage policies for the adjacency lists of LabeledDirectedGraph
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __EDGESTORAGE_HPP__
+#define __EDGESTORAGE_HPP__
+
+#include <vector>
+#include <memory>
+#include <utility>
+
+#include "graphtraits.hpp"
+
+namespace MyCoolGraphLibrary {
+
+  /**
+    @brief FullEdgeStorage stores the complete edge object in the adjacency
+           list of its source. This is the original behaviour of
+           LabeledDirectedGraph: operator[] returns a const reference to
+           the vector of edges.
+
+           An edge storage policy defines:
+           - Allocator: the allocator of the graph (ALLOC, rebound to the
+             element type of every container of the graph)
+           - Entry: the type stored in the adjacency vector
+           - EdgeVector: the adjacency vector
+           - EdgeRef: what the algorithms get when iterating over operator[]
+           - EdgeRange: the return type of operator[]
+           - entry(e): converts an edge to an Entry (may move from e)
+           - range(src,v): builds the EdgeRange of the adjacency vector v of src
+  */
+  template<typename GRAPHEDGE, typename ALLOC = std::allocator<GRAPHEDGE> >
+  struct FullEdgeStorage
+  {
+    typedef typename GRAPHEDGE::Node    Node;
+    typedef ALLOC                       Allocator;
+    typedef GRAPHEDGE                   Entry;
+    typedef std::vector<Entry,typename std::allocator_traits<ALLOC>::template rebind_alloc<Entry> >
+                                        EdgeVector;
+    typedef GRAPHEDGE                   EdgeRef;
+    typedef const EdgeVector&           EdgeRange;
+
+    static const Entry& entry(const GRAPHEDGE& e) { return e; }
+    static Entry&& entry(GRAPHEDGE&& e) { return std::move(e); }
+    static EdgeRange range(const Node&, const EdgeVector& v) { return v; }
+  }; // FullEdgeStorage
+
+
+  namespace detail {
+    /// Adjacency entry of CompactEdgeStorage for weighted edges
+    template<typename NODE, typename LABEL, typename WEIGHT, bool WEIGHTED>
+    struct CompactEntry
+    {
+      CompactEntry(const NODE& t, const LABEL& l, const WEIGHT& w)
+      : m_target(t), m_label(l), m_weight(w) {}
+
+      const NODE&  target() const { return m_target; }
+      const LABEL& label()  const { return m_label; }
+      WEIGHT       weight() const { return m_weight; }
+
+      NODE   m_target;
+      LABEL  m_label;
+      WEIGHT m_weight;
+    };
+
+    /// Adjacency entry of CompactEdgeStorage for unweighted edges
+    template<typename NODE, typename LABEL, typename WEIGHT>
+    struct CompactEntry<NODE,LABEL,WEIGHT,false>
+    {
+      CompactEntry(const NODE& t, const LABEL& l, const WEIGHT&)
+      : m_target(t), m_label(l) {}
+
+      const NODE&  target() const { return m_target; }
+      const LABEL& label()  const { return m_label; }
+      WEIGHT       weight() const { return 1; }
+
+      NODE   m_target;
+      LABEL  m_label;
+    };
+  } // namespace detail
+
+
+  /**
+    @brief CompactEdgeStorage stores only target, label and (for weighted
+           edge types) the weight in the adjacency list. The source is the
+           key of the adjacency list anyway, so it is not repeated in every
+           edge. Iterating over operator[] yields EdgeRef views which
+           offer source(), target(), label() and weight() like an edge.
+  */
+  template<typename GRAPHEDGE, typename ALLOC = std::allocator<GRAPHEDGE> >
+  struct CompactEdgeStorage
+  {
+    typedef typename GRAPHEDGE::Node                Node;
+    typedef typename GRAPHEDGE::Label               Label;
+    typedef typename edge_traits<GRAPHEDGE>::Weight Weight;
+    typedef ALLOC                                   Allocator;
+    typedef detail::CompactEntry<Node,Label,Weight,
+                                 edge_traits<GRAPHEDGE>::has_weight> Entry;
+    typedef std::vector<Entry,typename std::allocator_traits<ALLOC>::template rebind_alloc<Entry> >
+                                                    EdgeVector;
+
+    /// View of an adjacency entry together with its source
+    class EdgeRef
+    {
+    public:
+      typedef typename GRAPHEDGE::Node    Node;
+      typedef typename GRAPHEDGE::Label   Label;
+      typedef CompactEdgeStorage::Weight  Weight;
+
+      EdgeRef(const Node* s, const Entry* e) : src(s), entry(e) {}
+
+      const Node&  source() const { return *src; }
+      const Node&  target() const { return entry->target(); }
+      const Label& label()  const { return entry->label(); }
+      Weight       weight() const { return entry->weight(); }
+
+    private:
+      friend struct CompactEdgeStorage;
+      const Node*  src;
+      const Entry* entry;
+    }; // EdgeRef
+
+    /// Iterator yielding EdgeRef views
+    class EdgeIterator
+    {
+    public:
+      EdgeIterator(const Node* s, const Entry* e) : cur(s,e) {}
+
+      const EdgeRef& operator*()  const { return cur; }
+      const EdgeRef* operator->() const { return &cur; }
+      EdgeIterator& operator++() { ++cur.entry; return *this; }
+      bool operator==(const EdgeIterator& it) const { return cur.entry == it.cur.entry; }
+      bool operator!=(const EdgeIterator& it) const { return cur.entry != it.cur.entry; }
+
+    private:
+      EdgeRef cur;
+    }; // EdgeIterator
+
+    /// The leaving edges of a node
+    class EdgeRange
+    {
+    public:
+      EdgeRange(const Node* s, const Entry* b, const Entry* e)
+      : src(s), first(b), last(e) {}
+
+      EdgeIterator begin() const { return EdgeIterator(src,first); }
+      EdgeIterator end()   const { return EdgeIterator(src,last); }
+      std::size_t  size()  const { return last - first; }
+      bool         empty() const { return first == last; }
+
+    private:
+      const Node*  src;
+      const Entry* first;
+      const Entry* last;
+    }; // EdgeRange
+
+    static Entry entry(const GRAPHEDGE& e)
+    {
+      return Entry(e.target(),e.label(),edge_weight(e));
+    }
+
+    static EdgeRange range(const Node& src, const EdgeVector& v)
+    {
+      return EdgeRange(&src,v.data(),v.data() + v.size());
+    }
+  }; // CompactEdgeStorage
+
+} // namespace MyCoolGraphLibrary
+
+#endif
@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////
+// filemapping.hpp
+// Read-only memory mapping of files
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __FILEMAPPING_HPP__
+#define __FILEMAPPING_HPP__
+
+#include <string>
+#include <stdexcept>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace MyCoolGraphLibrary {
+
+  namespace detail {
+
+    /// Read-only memory mapping of a whole file, unmapped by the destructor
+    class FileMapping
+    {
+    public:
+      explicit FileMapping(const std::string& path) : m_data(0), m_size(0)
+      {
+        int fd = ::open(path.c_str(),O_RDONLY);
+        if (fd < 0)
+          throw std::runtime_error("cannot open " + path);
+        struct stat st;
+        if (::fstat(fd,&st) != 0) {
+          ::close(fd);
+          throw std::runtime_error("cannot stat " + path);
+        }
+        m_size = st.st_size;
+        if (m_size > 0) {
+          void* p = ::mmap(0,m_size,PROT_READ,MAP_SHARED,fd,0);
+          if (p == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("cannot map " + path);
+          }
+          m_data = static_cast<const unsigned char*>(p);
+        }
+        // The mapping stays valid after closing the descriptor
+        ::close(fd);
+      }
+
+      ~FileMapping()
+      {
+        if (m_data) ::munmap(const_cast<unsigned char*>(m_data),m_size);
+      }
+
+      const unsigned char* data() const { return m_data; }
+      std::size_t size() const { return m_size; }
+
+    private:
+      FileMapping(const FileMapping&);
+      FileMapping& operator=(const FileMapping&);
+
+      const unsigned char* m_data;
+      std::size_t          m_size;
+    }; // FileMapping
+
+  } // namespace detail
+
+} // namespace MyCoolGraphLibrary
+
+#endif
@@ -0,0 +1,400 @@
+////////////////////////////////////////////////////////////////////////////////
+// graph-bench.cpp
+// Benchmarks the graph algorithms on large synthetic graphs
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+// Usage: graph-bench [generator] [number of edges] [seed] [storage]
+//   generator: rmat (default), grid, regular or trie
+//   storage:   full (default) or compact, the edge storage policy of
+//              LabeledDirectedGraph
+// Build: g++ -std=c++17 -O2 graph-bench.cpp -o graph-bench -pthread
+//
+// The result is written to stdout as one JSON object. For every phase it
+// holds the time, the edges per second, the number and size of the
+// allocations in the phase and the peak RSS of the process so far:
+//   add              LabeledDirectedGraph::add() for all edges (without
+//                    the time of the generator, which is reported as
+//                    generate)
+//   freeze           CompressedGraph from the LabeledDirectedGraph
+//   bfs, dfs, distance_search
+//                    one search from node 0; edges per second counts the
+//                    leaving edges of all visited nodes
+//   graph_reverse    the reversed graph
+//   graph_as_dot     dot output to /dev/null through an OutputBuffer
+// Each phase is run on the LabeledDirectedGraph ("labeled", the generic
+// algorithms) and on the CompressedGraph ("compressed", the dense ones).
+// Compare the output of two builds to spot regressions.
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <atomic>
+#include <new>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
+#include <iostream>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include "wgraphedge.hpp"
+#include "labeledgraph.hpp"
+#include "compressedgraph.hpp"
+#include "bfs.hpp"
+#include "dfs.hpp"
+#include "dijkstra.hpp"
+#include "reverse.hpp"
+#include "graphoutput.hpp"
+
+using MyCoolGraphLibrary::WeightedGraphEdge;
+using MyCoolGraphLibrary::LabeledDirectedGraph;
+using MyCoolGraphLibrary::CompressedGraph;
+using MyCoolGraphLibrary::FullEdgeStorage;
+using MyCoolGraphLibrary::CompactEdgeStorage;
+using MyCoolGraphLibrary::OutputBuffer;
+
+typedef WeightedGraphEdge<unsigned,unsigned,unsigned> Edge;
+typedef std::chrono::steady_clock Clock;
+
+////////////////////////////////////////////////////////////////////////////////
+// Allocation counting: every operator new of the program goes through here
+
+static std::atomic<std::uint64_t> allocations(0);
+static std::atomic<std::uint64_t> allocated_bytes(0);
+
+// The replacements allocate with malloc() or aligned_alloc() and release
+// with free(), which is correct. When GCC inlines them into the standard
+// containers it only sees an operator new paired with free() and warns.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t n)
+{
+  allocations.fetch_add(1,std::memory_order_relaxed);
+  allocated_bytes.fetch_add(n,std::memory_order_relaxed);
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t n) { return operator new(n); }
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept
+{
+  allocations.fetch_add(1,std::memory_order_relaxed);
+  allocated_bytes.fetch_add(n,std::memory_order_relaxed);
+  return std::malloc(n ? n : 1);
+}
+
+void* operator new[](std::size_t n, const std::nothrow_t& t) noexcept { return operator new(n,t); }
+
+// The aligned versions are used by std::pmr::new_delete_resource()
+void* operator new(std::size_t n, std::align_val_t a)
+{
+  allocations.fetch_add(1,std::memory_order_relaxed);
+  allocated_bytes.fetch_add(n,std::memory_order_relaxed);
+  std::size_t alignment = std::max(std::size_t(a),sizeof(void*));
+  // aligned_alloc() wants a multiple of the alignment
+  std::size_t size = (std::max<std::size_t>(n,1) + alignment - 1) / alignment * alignment;
+  if (void* p = std::aligned_alloc(alignment,size)) return p;
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t n, std::align_val_t a) { return operator new(n,a); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Measuring
+
+/// Peak resident set size of the process in KiB
+long peak_rss_kib()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF,&usage);
+  return usage.ru_maxrss;
+}
+
+/// Collects the phases and writes them as JSON
+class Report
+{
+public:
+  /// Starts a phase
+  void start()
+  {
+    start_time = Clock::now();
+    start_allocations = allocations.load();
+    start_bytes = allocated_bytes.load();
+  }
+
+  /// Ends the phase name on graph, which processed the given number of edges
+  void stop(const char* name, const char* graph, std::uint64_t edges)
+  {
+    double seconds = std::chrono::duration<double>(Clock::now() - start_time).count();
+    std::string s = "    {\"phase\": \"" + std::string(name) + "\", \"graph\": \"" + graph + "\""
+      + ", \"seconds\": " + std::to_string(seconds)
+      + ", \"edges\": " + std::to_string(edges)
+      + ", \"edges_per_second\": " + std::to_string(seconds > 0 ? edges / seconds : 0.0)
+      + ", \"allocations\": " + std::to_string(allocations.load() - start_allocations)
+      + ", \"allocated_bytes\": " + std::to_string(allocated_bytes.load() - start_bytes)
+      + ", \"peak_rss_kib\": " + std::to_string(peak_rss_kib()) + "}";
+    phases.push_back(s);
+    std::cerr << name << " (" << graph << "): " << seconds << " s" << std::endl;
+  }
+
+  /// Writes the JSON object
+  void write(std::ostream& o, const std::string& header) const
+  {
+    o << "{\n" << header << "  \"phases\": [\n";
+    for (std::size_t i = 0; i < phases.size(); ++i) {
+      o << phases[i] << (i + 1 < phases.size() ? ",\n" : "\n");
+    }
+    o << "  ]\n}" << std::endl;
+  }
+
+private:
+  Clock::time_point start_time;
+  std::uint64_t start_allocations, start_bytes;
+  std::vector<std::string> phases;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Generators: each calls sink(source,label,target,weight) for m edges
+// (about m for grid and trie) and depends only on m and the seed. Node
+// ids are 0..n-1; weights are in 1..100.
+
+/// R-MAT (recursive matrix, the Graph500 Kronecker generator with
+/// a = 0.57, b = c = 0.19): 2^scale nodes with about 16 edges per node,
+/// a skewed degree distribution and hubs at small ids
+template<typename SINK>
+void generate_rmat(std::uint64_t m, unsigned seed, SINK& sink)
+{
+  unsigned scale = 1;
+  while (scale < 32 && (std::uint64_t(1) << scale) * 16 < m) ++scale;
+  // Quadrant thresholds in units of 1/65536
+  const unsigned a = 37356, ab = a + 12452, abc = ab + 12452;
+  std::mt19937_64 rng(seed);
+  for (std::uint64_t i = 0; i < m; ++i) {
+    unsigned u = 0, v = 0;
+    std::uint64_t bits = 0;
+    for (unsigned level = 0; level < scale; ++level) {
+      if (level % 4 == 0) bits = rng();
+      unsigned r = unsigned(bits & 0xffff);
+      bits >>= 16;
+      u <<= 1;
+      v <<= 1;
+      if (r >= abc) { u |= 1; v |= 1; }
+      else if (r >= ab) u |= 1;
+      else if (r >= a) v |= 1;
+    }
+    std::uint64_t x = rng();
+    sink(u,unsigned(x % 4),v,1 + unsigned((x >> 8) % 100));
+  }
+}
+
+/// Square grid with edges to the 4 neighbours, like a road map
+template<typename SINK>
+void generate_grid(std::uint64_t m, unsigned seed, SINK& sink)
+{
+  const unsigned side = std::max(2u,unsigned(std::sqrt(double(m) / 4)));
+  std::mt19937 rng(seed);
+  for (unsigned y = 0; y < side; ++y) {
+    for (unsigned x = 0; x < side; ++x) {
+      unsigned u = y * side + x;
+      if (x + 1 < side) {
+        sink(u,0,u+1,1 + rng() % 100);
+        sink(u+1,2,u,1 + rng() % 100);
+      }
+      if (y + 1 < side) {
+        sink(u,1,u+side,1 + rng() % 100);
+        sink(u+side,3,u,1 + rng() % 100);
+      }
+    }
+  }
+}
+
+/// Random 8-regular digraph: the union of 8 random permutations, so
+/// every node has 8 leaving and 8 entering edges (self loops and
+/// parallel edges are possible)
+template<typename SINK>
+void generate_regular(std::uint64_t m, unsigned seed, SINK& sink)
+{
+  const unsigned degree = 8;
+  const unsigned n = unsigned(std::max<std::uint64_t>(1,m / degree));
+  std::mt19937 rng(seed);
+  std::vector<unsigned> perm(n);
+  for (unsigned u = 0; u < n; ++u) perm[u] = u;
+  for (unsigned k = 0; k < degree; ++k) {
+    std::shuffle(perm.begin(),perm.end(),rng);
+    for (unsigned u = 0; u < n; ++u) {
+      sink(u,k,perm[u],1 + rng() % 100);
+    }
+  }
+}
+
+/// Trie-shaped tree like a lexicon: nodes are numbered level by level;
+/// the first levels branch widely, deeper nodes mostly have one child
+/// (mean 1.05), so long chains with occasional branches follow. Each
+/// edge is labelled by a distinct letter of its source.
+template<typename SINK>
+void generate_trie(std::uint64_t m, unsigned seed, SINK& sink)
+{
+  std::mt19937 rng(seed);
+  std::uint64_t edges = 0;
+  unsigned next = 1;            // next free node id
+  unsigned level_end = 1;       // first id of the next level
+  unsigned depth = 0;
+  for (unsigned u = 0; u < next && edges < m; ++u) {
+    if (u == level_end) {
+      ++depth;
+      level_end = next;
+    }
+    unsigned children;
+    if (depth == 0) children = 26;
+    else if (depth < 3) children = 1 + rng() % 20;
+    else {
+      unsigned r = rng() % 100;
+      children = (r < 25) ? 0 : (r < 75) ? 1 : (r < 95) ? 2 : 3;
+    }
+    unsigned first_letter = rng() % 26;
+    for (unsigned c = 0; c < children && edges < m; ++c, ++edges) {
+      sink(u,'a' + (first_letter + c) % 26,next++,1 + rng() % 100);
+    }
+  }
+}
+
+/// Runs generator name with sink; false if there is no such generator
+template<typename SINK>
+bool generate(const std::string& name, std::uint64_t m, unsigned seed, SINK& sink)
+{
+  if (name == "rmat") generate_rmat(m,seed,sink);
+  else if (name == "grid") generate_grid(m,seed,sink);
+  else if (name == "regular") generate_regular(m,seed,sink);
+  else if (name == "trie") generate_trie(m,seed,sink);
+  else return false;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Benchmark
+
+/// Visitor summing up the out-degrees of the visited nodes
+struct EdgeCounter
+{
+  EdgeCounter(const std::vector<unsigned>& d) : degree(d), edges(0) {}
+  void operator()(unsigned n) { edges += degree[n]; }
+  const std::vector<unsigned>& degree;
+  std::uint64_t edges;
+};
+
+/// Runs the searches, graph_reverse and graph_as_dot on g
+template<typename GRAPH>
+void run_algorithms(const GRAPH& g, const char* name, std::uint64_t m,
+                    const std::vector<unsigned>& degree, Report& report)
+{
+  EdgeCounter bfs_counter(degree);
+  report.start();
+  MyCoolGraphLibrary::breadth_first_search(g,0u,bfs_counter);
+  report.stop("bfs",name,bfs_counter.edges);
+
+  EdgeCounter dfs_counter(degree);
+  report.start();
+  MyCoolGraphLibrary::depth_first_search(g,0u,dfs_counter);
+  report.stop("dfs",name,dfs_counter.edges);
+
+  EdgeCounter dijkstra_counter(degree);
+  report.start();
+  MyCoolGraphLibrary::distance_search(g,0u,dijkstra_counter);
+  report.stop("distance_search",name,dijkstra_counter.edges);
+
+  {
+    report.start();
+    GRAPH reversed = MyCoolGraphLibrary::graph_reverse(g);
+    report.stop("graph_reverse",name,m);
+  }
+
+  int fd = ::open("/dev/null",O_WRONLY);
+  {
+    OutputBuffer out(fd);
+    report.start();
+    MyCoolGraphLibrary::graph_as_dot(g,out);
+    report.stop("graph_as_dot",name,m);
+  }
+  ::close(fd);
+}
+
+template<typename STORAGE>
+int run(const std::string& generator, std::uint64_t m, unsigned seed, const std::string& storage)
+{
+  Report report;
+
+  // Generator alone, to separate its time from add()
+  std::uint64_t m_generated = 0;
+  unsigned n = 0;
+  auto count = [&](unsigned u, unsigned, unsigned v, unsigned) {
+    ++m_generated;
+    n = std::max(n,std::max(u,v) + 1);
+  };
+  report.start();
+  if (!generate(generator,m,seed,count)) {
+    std::cerr << "Unknown generator " << generator << std::endl;
+    return EXIT_FAILURE;
+  }
+  report.stop("generate","none",m_generated);
+
+  std::vector<unsigned> degree(n,0);
+  LabeledDirectedGraph<Edge,STORAGE> g;
+  auto add = [&](unsigned u, unsigned l, unsigned v, unsigned w) { g.add(Edge(u,l,v,w)); };
+  report.start();
+  generate(generator,m,seed,add);
+  report.stop("add","labeled",m_generated);
+  for (auto u = g.nodes().begin(); u != g.nodes().end(); ++u) {
+    degree[*u] = g[*u].size();
+  }
+
+  report.start();
+  CompressedGraph<Edge> c(g);
+  report.stop("freeze","compressed",m_generated);
+
+  run_algorithms(g,"labeled",m_generated,degree,report);
+  run_algorithms(c,"compressed",m_generated,degree,report);
+
+  std::string header =
+    "  \"generator\": \"" + generator + "\",\n"
+    "  \"seed\": " + std::to_string(seed) + ",\n"
+    "  \"storage\": \"" + storage + "\",\n"
+    "  \"nodes\": " + std::to_string(c.no_of_nodes()) + ",\n"
+    "  \"edges\": " + std::to_string(c.no_of_edges()) + ",\n";
+  report.write(std::cout,header);
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[])
+{
+  const std::string generator = (argc > 1) ? argv[1] : "rmat";
+  const std::uint64_t m = (argc > 2) ? std::strtoull(argv[2],0,10) : 1000000;
+  const unsigned seed = (argc > 3) ? std::atoi(argv[3]) : 42;
+  const std::string storage = (argc > 4) ? argv[4] : "full";
+
+  if (storage == "full") return run< FullEdgeStorage<Edge> >(generator,m,seed,storage);
+  if (storage == "compact") return run< CompactEdgeStorage<Edge> >(generator,m,seed,storage);
+  std::cerr << "Unknown storage " << storage << std::endl;
+  return EXIT_FAILURE;
+}
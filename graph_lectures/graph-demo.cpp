@@ -12,6 +12,8 @@
 #include "graphedge.hpp"
 #include "wgraphedge.hpp"
 #include "labeledgraph.hpp"
+#include "compressedgraph.hpp"
+#include "stringdictionary.hpp"
 #include "dfs.hpp"
 #include "bfs.hpp"
 #include "graphoutput.hpp"
@@ -22,9 +24,13 @@
 using MyCoolGraphLibrary::SimpleGraphEdge;
 using MyCoolGraphLibrary::WeightedGraphEdge;
 using MyCoolGraphLibrary::LabeledDirectedGraph;
+using MyCoolGraphLibrary::CompressedGraph;
+using MyCoolGraphLibrary::StringDictionary;
 
 // Define a graph edge
 typedef WeightedGraphEdge<std::string,std::string> Edge;
+// Graph edge over interned strings
+typedef WeightedGraphEdge<StringDictionary::Handle,StringDictionary::Handle> InternedEdge;
 
 /// Visitor object which prints a node on a stream
 template<typename NODE>
@@ -39,6 +45,17 @@ struct NodePrinter
   std::ostream& out;  
 }; // NodePrinter
 
+/// Visitor object which prints the string of an interned node
+struct InternedNodePrinter
+{
+  InternedNodePrinter(const StringDictionary& d, std::ostream& o=std::cout) 
+  : dict(d), out(o) {}
+  void operator()(StringDictionary::Handle n) { out << dict.str(n) << std::endl; }
+
+  const StringDictionary& dict;
+  std::ostream& out;  
+}; // InternedNodePrinter
+
 /// Visitor object which stores a node in a vector
 template<typename NODE>
 class NodeStorer
@@ -142,4 +159,19 @@ int main()
 
   std::cout << "\nUse Dijkstras algorithm to find shortest paths from start to every other node:\n";
   MyCoolGraphLibrary::distance_search(lexicon,"<>",output_nodes_on);
+
+  std::cout << "\nFreeze the lexicon and do a BFS on the CSR snapshot:\n";
+  CompressedGraph<Edge> frozen_lexicon = MyCoolGraphLibrary::freeze(lexicon);
+  MyCoolGraphLibrary::breadth_first_search(frozen_lexicon,"<>",output_nodes_on);
+
+  std::cout << "\nBuild the movie graph over interned strings:\n";
+  StringDictionary dict;
+  LabeledDirectedGraph<InternedEdge> interned_movies;
+  interned_movies.add(InternedEdge(dict.intern("Ridley Scott"),dict.intern("directed"),dict.intern("Alien")));
+  interned_movies.add(InternedEdge(dict.intern("Ridley Scott"),dict.intern("directed"),dict.intern("Body of lies")));
+  interned_movies.add(InternedEdge(dict.intern("Leonardo diCaprio"),dict.intern("performed_in"),dict.intern("Body of lies")));
+  interned_movies.add(InternedEdge(dict.intern("Leonardo diCaprio"),dict.intern("performed_in"),dict.intern("Titanic")));
+  InternedNodePrinter output_interned_nodes_on(dict,std::cout);
+  MyCoolGraphLibrary::breadth_first_search(interned_movies,dict.find("Ridley Scott"),output_interned_nodes_on);
+  MyCoolGraphLibrary::graph_as_dot(interned_movies,std::cout,dict);
 }
@@ -0,0 +1,233 @@
+////////////////////////////////////////////////////////////////////////////////
+// graphbuilder.hpp
+// Bulk construction of graphs from large edge collections
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __GRAPHBUILDER_HPP__
+#define __GRAPHBUILDER_HPP__
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <functional>
+
+#include "graphtraits.hpp"
+#include "labeledgraph.hpp"
+#include "compressedgraph.hpp"
+#include "parallel.hpp"
+
+namespace MyCoolGraphLibrary {
+
+/**
+  @brief GraphBuilder collects edges and builds a LabeledDirectedGraph or a
+         CompressedGraph from them in one go.
+         Instead of one add() per edge (two set inserts and a map lookup
+         each), the edges are stably sorted by source on several threads,
+         the node set is computed by sorting, and every adjacency vector
+         is allocated with its exact size. The result is the same graph
+         as adding the edges one by one in the order they were given.
+*/
+template<typename GRAPHEDGE>
+class GraphBuilder
+{
+public: // Types
+  typedef GRAPHEDGE                                   GraphEdge;
+  typedef typename GraphEdge::Node                    Node;
+  typedef typename GraphEdge::Label                   Label;
+  typedef std::vector<GraphEdge>                      EdgeVector;
+
+public:
+  /// Constructor. nthreads is the number of threads used for building.
+  GraphBuilder(unsigned nthreads = detail::default_concurrency())
+  : m_threads(nthreads > 0 ? nthreads : 1) {}
+
+  /// Reserve memory for n edges
+  void reserve(std::size_t n) { m_edges.reserve(n); }
+
+  /// Add an edge src --label--> tgt
+  void add(const GraphEdge& e) { m_edges.push_back(e); }
+  void add(GraphEdge&& e)      { m_edges.push_back(std::move(e)); }
+
+  /// Add all edges of a range
+  template<typename ITERATOR>
+  void add(ITERATOR first, ITERATOR last) { m_edges.insert(m_edges.end(),first,last); }
+
+  /// Returns the number of collected edges
+  std::size_t size() const { return m_edges.size(); }
+
+  /// Returns the number of threads used for building
+  unsigned threads() const { return m_threads; }
+
+  /**
+    @brief Adds the collected edges to g. If g is empty (the normal case)
+           its node set and adjacency lists are built in one pass,
+           otherwise the edges are simply added one by one.
+           The builder is empty afterwards.
+  */
+  template<typename STORAGE>
+  void build(LabeledDirectedGraph<GraphEdge,STORAGE>& g)
+  {
+    typedef LabeledDirectedGraph<GraphEdge,STORAGE> Graph;
+    typedef typename Graph::EdgeVector              AdjacencyVector;
+
+    if (!g.nodes().empty()) {
+      for (auto e = m_edges.begin(); e != m_edges.end(); ++e) {
+        g.add(*e);
+      }
+      m_edges.clear();
+      return;
+    }
+
+    sort_by_source();
+    std::vector<Node> nodes = collect_nodes();
+    std::vector<std::size_t> runs = source_runs();
+
+    // The set and the map are filled in sorted order, so each insertion
+    // takes amortized constant time. The adjacency vectors get their
+    // exact size here, so that only this thread uses the allocator of
+    // the graph (memory resources are usually not thread-safe).
+    g.m_nodes.insert(nodes.begin(),nodes.end());
+    std::vector<AdjacencyVector*> adjacency(runs.size()-1);
+    for (std::size_t r = 0; r < adjacency.size(); ++r) {
+      auto it = g.m_matrix.emplace_hint(g.m_matrix.end(),m_edges[runs[r]].source(),
+                                        AdjacencyVector());
+      adjacency[r] = &it->second;
+      adjacency[r]->reserve(runs[r+1] - runs[r]);
+    }
+
+    // Fill the adjacency vectors in parallel
+    detail::parallel_for(adjacency.size(),m_threads,[&](std::size_t b, std::size_t e, unsigned) {
+      for (std::size_t r = b; r < e; ++r) {
+        AdjacencyVector& v = *adjacency[r];
+        for (std::size_t i = runs[r]; i < runs[r+1]; ++i) {
+          v.push_back(STORAGE::entry(std::move(m_edges[i])));
+        }
+      }
+    });
+    m_edges.clear();
+    if (g.has_in_edge_index()) g.build_in_edges();
+  }
+
+  /// Returns a new graph containing the collected edges
+  LabeledDirectedGraph<GraphEdge> build()
+  {
+    LabeledDirectedGraph<GraphEdge> g;
+    build(g);
+    return g;
+  }
+
+  /**
+    @brief Returns a CompressedGraph containing the collected edges.
+           It equals freeze(build()), but no intermediate graph is built.
+           The builder is empty afterwards.
+  */
+  CompressedGraph<GraphEdge> build_compressed()
+  {
+    typedef CompressedGraph<GraphEdge>    Graph;
+    typedef typename Graph::NodeId        NodeId;
+    typedef typename Graph::EdgeIndex     EdgeIndex;
+    typedef typename Graph::Weight        Weight;
+    const bool weighted = edge_traits<GraphEdge>::has_weight;
+
+    sort_by_source();
+    std::vector<Node> nodes = collect_nodes();
+    std::vector<std::size_t> runs = source_runs();
+
+    // Offsets: walk the (sorted) node vector and the source runs in lockstep
+    std::vector<EdgeIndex> offsets(nodes.size()+1,0);
+    std::size_t r = 0;
+    for (std::size_t u = 0; u < nodes.size(); ++u) {
+      if (r + 1 < runs.size() && !(nodes[u] < m_edges[runs[r]].source())) {
+        offsets[u+1] = offsets[u] + (runs[r+1] - runs[r]);
+        ++r;
+      }
+      else {
+        offsets[u+1] = offsets[u];
+      }
+    }
+
+    // Edge arrays are written at fixed positions, so threads don't interfere
+    std::vector<NodeId> targets(m_edges.size());
+    std::vector<Label>  labels(m_edges.size());
+    std::vector<Weight> weights(weighted ? m_edges.size() : 0);
+    detail::parallel_for(m_edges.size(),m_threads,[&](std::size_t b, std::size_t e, unsigned) {
+      for (std::size_t i = b; i < e; ++i) {
+        targets[i] = std::lower_bound(nodes.begin(),nodes.end(),m_edges[i].target()) - nodes.begin();
+        labels[i] = m_edges[i].label();
+        if (weighted)
+          weights[i] = edge_weight(m_edges[i]);
+      }
+    });
+    m_edges.clear();
+    return Graph(std::move(nodes),std::move(offsets),std::move(targets),
+                 std::move(labels),std::move(weights));
+  }
+
+private: // Functions
+  /// Stable sort of the edges by source node
+  void sort_by_source()
+  {
+    detail::parallel_stable_sort(m_edges.begin(),m_edges.end(),
+      [](const GraphEdge& a, const GraphEdge& b) { return a.source() < b.source(); },
+      m_threads);
+  }
+
+  /// Returns the sorted vector of all sources and targets (without duplicates).
+  /// The edges must be sorted by source.
+  std::vector<Node> collect_nodes() const
+  {
+    std::vector<Node> sources;
+    for (auto e = m_edges.begin(); e != m_edges.end(); ++e) {
+      if (sources.empty() || sources.back() < e->source())
+        sources.push_back(e->source());
+    }
+    std::vector<Node> targets;
+    targets.reserve(m_edges.size());
+    for (auto e = m_edges.begin(); e != m_edges.end(); ++e) {
+      targets.push_back(e->target());
+    }
+    detail::parallel_stable_sort(targets.begin(),targets.end(),std::less<Node>(),m_threads);
+    targets.erase(std::unique(targets.begin(),targets.end()),targets.end());
+
+    std::vector<Node> nodes;
+    nodes.reserve(sources.size() + targets.size());
+    std::set_union(sources.begin(),sources.end(),targets.begin(),targets.end(),
+                   std::back_inserter(nodes));
+    return nodes;
+  }
+
+  /// Returns the start positions of the runs of equal sources, followed by
+  /// the number of edges. The edges must be sorted by source.
+  std::vector<std::size_t> source_runs() const
+  {
+    std::vector<std::size_t> runs;
+    for (std::size_t i = 0; i < m_edges.size(); ++i) {
+      if (i == 0 || m_edges[i-1].source() < m_edges[i].source())
+        runs.push_back(i);
+    }
+    runs.push_back(m_edges.size());
+    return runs;
+  }
+
+private:
+  EdgeVector m_edges;   ///< Collected edges
+  unsigned   m_threads; ///< Number of threads used for building
+}; // GraphBuilder
+
+
+/// Builds a graph from the edges in [first,last) with a GraphBuilder
+template<typename ITERATOR>
+LabeledDirectedGraph<typename std::iterator_traits<ITERATOR>::value_type>
+graph_from_edges(ITERATOR first, ITERATOR last,
+                 unsigned nthreads = detail::default_concurrency())
+{
+  GraphBuilder<typename std::iterator_traits<ITERATOR>::value_type> builder(nthreads);
+  builder.add(first,last);
+  return builder.build();
+}
+
+} // namespace MyCoolGraphLibrary
+
+#endif
@@ -23,7 +23,7 @@ public:
   
   const Node& source() const { return m_source; }
   const Node& target() const { return m_target; }
-  const Node& label()  const { return m_label; }
+  const Label& label() const { return m_label; }
   
 protected: // "protected" means that the following is accessible for derived classes
   Node  m_source;
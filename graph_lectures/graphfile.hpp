@@ -0,0 +1,350 @@
+////////////////////////////////////////////////////////////////////////////////
+// graphfile.hpp
+// Binary graph file format and zero-copy loading via mmap
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __GRAPHFILE_HPP__
+#define __GRAPHFILE_HPP__
+
+#include <string>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+#include "filemapping.hpp"
+#include "compressedgraph.hpp"
+#include "stringdictionary.hpp"
+
+namespace MyCoolGraphLibrary {
+
+  /*
+    Graph file format, version 1. All numbers are little-endian.
+
+    Header (128 bytes):
+      char   magic[8]        "MCGRAPH\0"
+      uint32 version         1
+      uint32 flags           bit 0: the graph has edge weights
+      uint64 no_of_nodes     n
+      uint64 no_of_edges     m
+      uint64 no_of_strings   s
+      uint64 arena_size      bytes of string data
+      uint64 table_size      slots of the string hash table
+      uint64 section[9]      file offsets of the sections below
+
+    Sections (each starts at a multiple of 8):
+      0 nodes         uint32[n]    node handles, sorted
+      1 offsets       uint64[n+1]  CSR offsets
+      2 targets       uint32[m]    target node ids
+      3 labels        uint32[m]    label handles
+      4 weights       uint32[m]    edge weights (empty if not weighted)
+      5 str_offsets   uint64[s+1]  start of each string in the arena
+      6 hashes        uint32[s]    hash value of each string
+      7 table         uint32[t]    string hash table
+      8 arena         char[]       '\0'-terminated strings
+
+    The sections are exactly the arrays of CompressedGraph and
+    StringDictionary, so a mapped file is used without any conversion.
+  */
+
+  namespace detail {
+
+    const char          graph_file_magic[8]   = { 'M','C','G','R','A','P','H','\0' };
+    const std::uint32_t graph_file_version    = 1;
+    const std::uint32_t graph_file_weighted   = 1;
+    const std::size_t   graph_file_header_size = 128;
+    const unsigned      graph_file_sections   = 9;
+
+    /// The sections are stored as they are in memory, which is only
+    /// possible on little-endian machines
+    inline bool host_is_little_endian()
+    {
+      const std::uint16_t one = 1;
+      unsigned char c;
+      std::memcpy(&c,&one,1);
+      return c == 1;
+    }
+
+    inline void put_u32(unsigned char* p, std::uint32_t v)
+    {
+      for (unsigned i = 0; i < 4; ++i) p[i] = (v >> (8*i)) & 0xff;
+    }
+
+    inline void put_u64(unsigned char* p, std::uint64_t v)
+    {
+      for (unsigned i = 0; i < 8; ++i) p[i] = (v >> (8*i)) & 0xff;
+    }
+
+    inline std::uint32_t get_u32(const unsigned char* p)
+    {
+      std::uint32_t v = 0;
+      for (unsigned i = 0; i < 4; ++i) v |= std::uint32_t(p[i]) << (8*i);
+      return v;
+    }
+
+    inline std::uint64_t get_u64(const unsigned char* p)
+    {
+      std::uint64_t v = 0;
+      for (unsigned i = 0; i < 8; ++i) v |= std::uint64_t(p[i]) << (8*i);
+      return v;
+    }
+
+    /// Finds the k sections of a mapped file of size bytes starting at p,
+    /// whose file offsets are stored at offsets. Section i must start at a
+    /// multiple of 8 and hold counts[i] elements of widths[i] bytes within
+    /// the file; otherwise std::runtime_error is thrown. The counts must
+    /// already be checked against the id types, so that n+1 cannot wrap.
+    inline void locate_file_sections(const unsigned char* p, std::size_t size,
+                                     const unsigned char* offsets, unsigned k,
+                                     const std::uint64_t* counts, const std::uint64_t* widths,
+                                     const unsigned char** sections, const std::string& path)
+    {
+      for (unsigned i = 0; i < k; ++i) {
+        std::uint64_t pos = get_u64(offsets+8*i);
+        // Divide instead of multiplying, which could overflow
+        if (pos % 8 != 0 || pos > size || counts[i] > (size - pos) / widths[i])
+          throw std::runtime_error(path + " is truncated or corrupt");
+        sections[i] = p + pos;
+      }
+    }
+
+    /// Checks the ends of a mapped offset array with n+1 entries of 64 bit:
+    /// it must start at 0 and end at last. Together with the section sizes
+    /// this keeps the last range within its array.
+    inline void check_file_offsets(const unsigned char* offsets, std::uint64_t n,
+                                   std::uint64_t last, const std::string& path)
+    {
+      if (get_u64(offsets) != 0 || get_u64(offsets+8*n) != last)
+        throw std::runtime_error(path + " is truncated or corrupt");
+    }
+
+    /// Checks the contents of mapped CSR arrays in O(n+m): the offsets
+    /// must not decrease and all targets must be node ids below n
+    template<typename OFFSETS, typename TARGETS>
+    void check_file_csr(const OFFSETS& offsets, const TARGETS& targets, std::uint64_t n,
+                        const std::string& path)
+    {
+      typedef typename std::decay<decltype(*targets.begin())>::type NodeId;
+      if (!std::is_sorted(offsets.begin(),offsets.end()) ||
+          !std::all_of(targets.begin(),targets.end(),[n](NodeId v) { return v < n; }))
+        throw std::runtime_error(path + " is corrupt");
+    }
+
+    /// Checks that the edge type can be stored in a graph file
+    template<typename GRAPHEDGE>
+    struct check_graph_file_edge
+    {
+      typedef CompressedGraph<GRAPHEDGE> Graph;
+      static_assert(std::is_same<typename Graph::Node,StringDictionary::Handle>::value,
+                    "graph files store graphs over StringDictionary handles");
+      static_assert(std::is_same<typename Graph::Label,StringDictionary::Handle>::value,
+                    "graph files store labels as StringDictionary handles");
+      static_assert(!edge_traits<GRAPHEDGE>::has_weight ||
+                    (std::is_integral<typename Graph::Weight>::value &&
+                     sizeof(typename Graph::Weight) == 4),
+                    "graph files store 32 bit integer weights");
+    };
+
+  } // namespace detail
+
+
+  /**
+    @brief Writes graph g over the handles of dictionary dict to a graph
+           file (see the format description above).
+  */
+  template<typename GRAPHEDGE>
+  void write_graph_file(const std::string& path,
+                        const CompressedGraph<GRAPHEDGE>& g,
+                        const StringDictionary& dict)
+  {
+    detail::check_graph_file_edge<GRAPHEDGE> check;
+    (void) check;
+    if (!detail::host_is_little_endian())
+      throw std::runtime_error("graph files can only be written on little-endian machines");
+
+    const bool weighted = edge_traits<GRAPHEDGE>::has_weight;
+    // Section sizes in bytes
+    std::uint64_t sizes[detail::graph_file_sections] = {
+      g.nodes().size() * sizeof(std::uint32_t),
+      g.offset_array().size() * sizeof(std::uint64_t),
+      g.target_array().size() * sizeof(std::uint32_t),
+      g.label_array().size() * sizeof(std::uint32_t),
+      weighted ? g.weight_array().size() * sizeof(std::uint32_t) : 0,
+      dict.offsets().size() * sizeof(std::uint64_t),
+      dict.hashes().size() * sizeof(std::uint32_t),
+      dict.table().size() * sizeof(std::uint32_t),
+      dict.arena().size()
+    };
+    const void* data[detail::graph_file_sections] = {
+      g.nodes().data(), g.offset_array().data(), g.target_array().data(),
+      g.label_array().data(), g.weight_array().data(), dict.offsets().data(),
+      dict.hashes().data(), dict.table().data(), dict.arena().data()
+    };
+
+    // Header
+    unsigned char header[detail::graph_file_header_size];
+    std::memset(header,0,sizeof(header));
+    std::memcpy(header,detail::graph_file_magic,8);
+    detail::put_u32(header+8,detail::graph_file_version);
+    detail::put_u32(header+12,weighted ? detail::graph_file_weighted : 0);
+    detail::put_u64(header+16,g.no_of_nodes());
+    detail::put_u64(header+24,g.no_of_edges());
+    detail::put_u64(header+32,dict.size());
+    detail::put_u64(header+40,dict.arena().size());
+    detail::put_u64(header+48,dict.table().size());
+    std::uint64_t pos = detail::graph_file_header_size;
+    for (unsigned i = 0; i < detail::graph_file_sections; ++i) {
+      detail::put_u64(header+56+8*i,pos);
+      pos = (pos + sizes[i] + 7) / 8 * 8;
+    }
+
+    std::ofstream out(path.c_str(),std::ios::binary);
+    if (!out)
+      throw std::runtime_error("cannot create " + path);
+    out.write(reinterpret_cast<const char*>(header),sizeof(header));
+    const char padding[8] = { 0 };
+    for (unsigned i = 0; i < detail::graph_file_sections; ++i) {
+      if (sizes[i] > 0)
+        out.write(static_cast<const char*>(data[i]),sizes[i]);
+      out.write(padding,(8 - sizes[i] % 8) % 8);
+    }
+    if (!out)
+      throw std::runtime_error("error writing " + path);
+  }
+
+
+  /**
+    @brief MappedGraphFile maps a graph file into memory. graph() and
+           dictionary() refer directly to the mapping: nothing is parsed
+           or copied, and processes mapping the same file share its pages.
+           Both objects (and their copies) keep the mapping alive, so they
+           may outlive the MappedGraphFile.
+  */
+  template<typename GRAPHEDGE>
+  class MappedGraphFile
+  {
+  public: // Types
+    typedef CompressedGraph<GRAPHEDGE>    Graph;
+    typedef typename Graph::NodeId        NodeId;
+    typedef typename Graph::EdgeIndex     EdgeIndex;
+    typedef typename Graph::Weight        Weight;
+    typedef StringDictionary::Handle      Handle;
+    typedef StringDictionary::Offset      Offset;
+
+  public:
+    /**
+      @brief Maps the file and throws std::runtime_error if it is not a
+             valid graph file. The header and the section sizes are always
+             checked. With validate (the default), a pass over all arrays
+             in O(n+m+s) also checks that node ids, handles and offsets are
+             in range, so that no search or lookup can leave the mapping.
+             Only skip it for files that are known to be intact.
+    */
+    explicit MappedGraphFile(const std::string& path, bool validate = true)
+    {
+      detail::check_graph_file_edge<GRAPHEDGE> check;
+      (void) check;
+      if (!detail::host_is_little_endian())
+        throw std::runtime_error("graph files can only be mapped on little-endian machines");
+
+      std::shared_ptr<detail::FileMapping> mapping(new detail::FileMapping(path));
+      const unsigned char* p = mapping->data();
+      std::size_t size = mapping->size();
+
+      if (size < detail::graph_file_header_size || std::memcmp(p,detail::graph_file_magic,8) != 0)
+        throw std::runtime_error(path + " is not a graph file");
+      if (detail::get_u32(p+8) != detail::graph_file_version)
+        throw std::runtime_error(path + " has an unsupported version");
+      bool weighted = (detail::get_u32(p+12) & detail::graph_file_weighted) != 0;
+      if (weighted != edge_traits<GRAPHEDGE>::has_weight)
+        throw std::runtime_error(path + " does not match the edge type (weights)");
+
+      std::uint64_t n = detail::get_u64(p+16);
+      std::uint64_t m = detail::get_u64(p+24);
+      std::uint64_t s = detail::get_u64(p+32);
+      std::uint64_t arena_size = detail::get_u64(p+40);
+      std::uint64_t table_size = detail::get_u64(p+48);
+      // The ids must fit their 32 bit types; the hash table is probed with
+      // a mask and needs at least one free slot to end a search
+      if (n >= Graph::NoNode() || s >= StringDictionary::NoHandle() ||
+          table_size <= s || (table_size & (table_size - 1)) != 0)
+        throw std::runtime_error(path + " is truncated or corrupt");
+      std::uint64_t counts[detail::graph_file_sections] = {
+        n, n+1, m, m, weighted ? m : 0, s+1, s, table_size, arena_size
+      };
+      std::uint64_t widths[detail::graph_file_sections] = { 4, 8, 4, 4, 4, 8, 4, 4, 1 };
+      const unsigned char* sections[detail::graph_file_sections];
+      detail::locate_file_sections(p,size,p+56,detail::graph_file_sections,
+                                   counts,widths,sections,path);
+      detail::check_file_offsets(sections[1],n,m,path);
+      detail::check_file_offsets(sections[5],s,arena_size,path);
+      // Every string, in particular the last one, is '\0'-terminated
+      if ((s > 0 || arena_size > 0) &&
+          (arena_size == 0 || sections[8][arena_size-1] != '\0'))
+        throw std::runtime_error(path + " is truncated or corrupt");
+
+      m_graph = Graph(
+        detail::ArrayRef<Handle>(reinterpret_cast<const Handle*>(sections[0]),n),
+        detail::ArrayRef<EdgeIndex>(reinterpret_cast<const EdgeIndex*>(sections[1]),n+1),
+        detail::ArrayRef<NodeId>(reinterpret_cast<const NodeId*>(sections[2]),m),
+        detail::ArrayRef<Handle>(reinterpret_cast<const Handle*>(sections[3]),m),
+        detail::ArrayRef<Weight>(reinterpret_cast<const Weight*>(sections[4]),weighted ? m : 0),
+        mapping);
+      m_dictionary = StringDictionary(
+        detail::ArrayRef<char>(reinterpret_cast<const char*>(sections[8]),arena_size),
+        detail::ArrayRef<Offset>(reinterpret_cast<const Offset*>(sections[5]),s+1),
+        detail::ArrayRef<std::uint32_t>(reinterpret_cast<const std::uint32_t*>(sections[6]),s),
+        detail::ArrayRef<Handle>(reinterpret_cast<const Handle*>(sections[7]),table_size),
+        mapping);
+      if (validate) check_contents(path);
+    }
+
+    /// The graph stored in the file
+    const Graph& graph() const { return m_graph; }
+
+    /// The dictionary of node and label strings
+    const StringDictionary& dictionary() const { return m_dictionary; }
+
+  private:
+    /// Checks all ids and offsets in the mapped arrays
+    void check_contents(const std::string& path) const
+    {
+      const Handle s = m_dictionary.size();
+      auto valid_handle = [s](Handle h) { return h < s; };
+      detail::check_file_csr(m_graph.offset_array(),m_graph.target_array(),
+                             m_graph.no_of_nodes(),path);
+      // Nodes are sorted without duplicates, since id() searches them
+      const auto& nodes = m_graph.nodes();
+      if (!std::all_of(nodes.begin(),nodes.end(),valid_handle) ||
+          std::adjacent_find(nodes.begin(),nodes.end(),
+                             [](Handle a, Handle b) { return !(a < b); }) != nodes.end() ||
+          !std::all_of(m_graph.label_array().begin(),m_graph.label_array().end(),valid_handle))
+        throw std::runtime_error(path + " is corrupt");
+
+      // Every string is '\0'-terminated and thus at least one byte long
+      const auto& offsets = m_dictionary.offsets();
+      const auto& arena = m_dictionary.arena();
+      for (Handle h = 0; h < s; ++h) {
+        if (!(offsets[h] < offsets[h+1]) || arena[offsets[h+1]-1] != '\0')
+          throw std::runtime_error(path + " is corrupt");
+      }
+      // The table holds handles or free slots, at least one of them free
+      const auto& table = m_dictionary.table();
+      if (std::find(table.begin(),table.end(),StringDictionary::NoHandle()) == table.end() ||
+          !std::all_of(table.begin(),table.end(),[s](Handle h) {
+            return h < s || h == StringDictionary::NoHandle(); }))
+        throw std::runtime_error(path + " is corrupt");
+    }
+
+  private:
+    Graph            m_graph;
+    StringDictionary m_dictionary;
+  }; // MappedGraphFile
+
+} // namespace MyCoolGraphLibrary
+
+#endif
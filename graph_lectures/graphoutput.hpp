@@ -8,71 +8,246 @@
 #define __GRAPHOUTPUT_HPP__
 
 #include <iostream>
+#include <memory>
+#include <type_traits>
 
 #include "labeledgraph.hpp"
 #include "graphtransform.hpp"
+#include "outputbuffer.hpp"
 
 namespace MyCoolGraphLibrary {
 
-  /** 
+  namespace detail {
+    /// Default naming for output: nodes and labels are written as they are
+    struct IdentityNames
+    {
+      template<typename T>
+      const T& name(const T& x) const { return x; }
+    };
+
+    /**
+      @brief Common part of the outputters: the OutputBuffer everything is
+             written to (either the caller's or an own one around a
+             stream) and the names. Workers of the parallel
+             graph_transform() get an own buffer without a sink, which
+             merge() appends to the buffer of the main outputter, so the
+             output keeps the order of the nodes.
+    */
+    template<typename NAMES>
+    struct BufferedOutputter
+    {
+      /// Writes to stream o through an own buffer
+      BufferedOutputter(std::ostream& o, const NAMES& n)
+      : BufferedOutputter(std::make_shared<OutputBuffer>(o),n) {}
+
+      /// Writes to the buffer b
+      BufferedOutputter(OutputBuffer& b, const NAMES& n) : out(b), names(n) {}
+
+      /// Writes to the buffer b, which it keeps alive
+      BufferedOutputter(const std::shared_ptr<OutputBuffer>& b, const NAMES& n)
+      : out(*b), names(n), own_buffer(b) {}
+
+      /// Appends the output of the worker w
+      void merge(BufferedOutputter& w)
+      {
+        out.write(w.out.data(),w.out.size());
+        w.out.clear();
+      }
+
+      OutputBuffer& out;    ///< Buffer where everything is written to
+      NAMES names;          ///< Converts nodes and labels to text
+      std::shared_ptr<OutputBuffer> own_buffer;
+    }; // BufferedOutputter
+  }
+
+  /**
     @brief Function object for outputting graphs as dot
            Each outputter function object has 4 functions:
            1. prolog(): output stuff before the actual graph is outputted.
            2. operator()(Node&): output a node
            3. operation()(Edge&): output an edge
            4. epilog(): output stuff after the graph has been outputted
+           The NAMES object converts nodes and labels to their text with
+           its name() function, e.g. a StringDictionary for graphs over
+           interned strings.
+           Output goes through an OutputBuffer, which is flushed by
+           epilog(). For the parallel graph_transform() the workers
+           (clone()) write into buffers of their own, which merge()
+           appends in the order of the nodes.
   */
-  template<typename GRAPHEDGE>
-  struct GraphDotOutputter
+  template<typename GRAPHEDGE, typename NAMES = detail::IdentityNames>
+  struct GraphDotOutputter : public detail::BufferedOutputter<NAMES>
   {
+    typedef detail::BufferedOutputter<NAMES> Base;
+    using Base::out;
+    using Base::names;
+
     /// Constructor takes an ostream reference
-    GraphDotOutputter(std::ostream& o) : out(o) {}
-     
+    GraphDotOutputter(std::ostream& o, const NAMES& n = NAMES()) : Base(o,n) {}
+
+    /// Constructor writing to an OutputBuffer, e.g. one on a file descriptor
+    GraphDotOutputter(OutputBuffer& b, const NAMES& n = NAMES()) : Base(b,n) {}
+
     /// Write dot prolog
     void prolog()
     {
-      out << "digraph CoolGraph {" << std::endl;
-      out << "  graph [rankdir = LR, center = 1, orientation = Portrait]" << std::endl;
-      out << "  node [fontsize = 14, shape = box, style = filled, color = blue, fontcolor = white]" << std::endl;
-      out << "  edge [fontsize = 14 ];" << std::endl << std::endl;
+      out << "digraph CoolGraph {\n"
+             "  graph [rankdir = LR, center = 1, orientation = Portrait]\n"
+             "  node [fontsize = 14, shape = box, style = filled, color = blue, fontcolor = white]\n"
+             "  edge [fontsize = 14 ];\n\n";
     }
-    
+
     /// Node output
     void operator()(const typename GRAPHEDGE::Node& node)
     {
-      out << "  " << "\"" << node << "\"" << std::endl;
+      out << "  \"" << names.name(node) << "\"\n";
     }
-      
-    /// Edge output
-    void operator()(const GRAPHEDGE& edge)
+
+    /// Edge output (GRAPHEDGE or an edge view with the same interface)
+    template<typename EDGE>
+    void operator()(const EDGE& edge)
     {
-      const char* quote = "\"";
-      out << "  " << quote << edge.source() << quote
-          << " -> " << quote << edge.target() << quote
-          << " [label = " << quote << edge.label() << quote 
-          << "]" << std::endl;
+      out << "  \"" << names.name(edge.source())
+          << "\" -> \"" << names.name(edge.target())
+          << "\" [label = \"" << names.name(edge.label()) << "\"]\n";
     }
 
     /// Write dot epilog
     void epilog()
     {
-      out << "}" << std::endl;
+      out << "}\n";
+      out.flush();
     }
-    
-    std::ostream& out; ///< Stream where everything is written to
+
+    /// Worker for the parallel graph_transform(): writes into a buffer
+    GraphDotOutputter clone() const
+    {
+      return GraphDotOutputter(std::make_shared<OutputBuffer>(),names);
+    }
+
+  private:
+    GraphDotOutputter(const std::shared_ptr<OutputBuffer>& b, const NAMES& n) : Base(b,n) {}
   }; // GraphDotOutputter
 
+  /**
+    @brief Function object for outputting graphs as an edge list with one
+           edge per line: source, label, target and, for weighted edge
+           types, the weight, separated by tabs (the format EdgeListReader
+           reads). Nodes without edges do not appear.
+  */
+  template<typename GRAPHEDGE, typename NAMES = detail::IdentityNames>
+  struct GraphTsvOutputter : public detail::BufferedOutputter<NAMES>
+  {
+    typedef detail::BufferedOutputter<NAMES> Base;
+    using Base::out;
+    using Base::names;
+
+    /// Constructor takes an ostream reference
+    GraphTsvOutputter(std::ostream& o, const NAMES& n = NAMES()) : Base(o,n) {}
+
+    /// Constructor writing to an OutputBuffer
+    GraphTsvOutputter(OutputBuffer& b, const NAMES& n = NAMES()) : Base(b,n) {}
+
+    void prolog() {}
+    void operator()(const typename GRAPHEDGE::Node&) {}
+
+    /// Edge output (GRAPHEDGE or an edge view with the same interface)
+    template<typename EDGE>
+    void operator()(const EDGE& edge)
+    {
+      out << names.name(edge.source()) << '\t' << names.name(edge.label())
+          << '\t' << names.name(edge.target());
+      write_weight(edge,std::integral_constant<bool,edge_traits<GRAPHEDGE>::has_weight>());
+      out.put('\n');
+    }
+
+    void epilog() { out.flush(); }
+
+    /// Worker for the parallel graph_transform(): writes into a buffer
+    GraphTsvOutputter clone() const
+    {
+      return GraphTsvOutputter(std::make_shared<OutputBuffer>(),names);
+    }
+
+  private:
+    GraphTsvOutputter(const std::shared_ptr<OutputBuffer>& b, const NAMES& n) : Base(b,n) {}
+
+    /// Writes the weight as a number; the unary + turns char weights into
+    /// int, which would otherwise be written as characters
+    template<typename EDGE>
+    void write_weight(const EDGE& edge, std::true_type) { out << '\t' << +edge.weight(); }
+
+    template<typename EDGE>
+    void write_weight(const EDGE&, std::false_type) {}
+  }; // GraphTsvOutputter
+
   /// Output graph in graphviz dot format.
-  template<typename GRAPHEDGE>
-  void graph_as_dot(const LabeledDirectedGraph<GRAPHEDGE>& g,
+  template<typename GRAPH>
+  void graph_as_dot(const GRAPH& g,
                     std::ostream& o)
   {
     // Construct dot output function object
-    GraphDotOutputter<GRAPHEDGE> dot_outputter(o);
+    GraphDotOutputter<typename GRAPH::GraphEdge> dot_outputter(o);
     // Call generic transformation function which creates the dot output
     graph_transform(g,dot_outputter);
   }
 
+  /// Output graph in graphviz dot format. Nodes and labels are converted
+  /// to text by names.name(), e.g. for graphs over StringDictionary handles.
+  template<typename GRAPH, typename NAMES>
+  void graph_as_dot(const GRAPH& g,
+                    std::ostream& o,
+                    const NAMES& names)
+  {
+    GraphDotOutputter<typename GRAPH::GraphEdge,const NAMES&> dot_outputter(o,names);
+    graph_transform(g,dot_outputter);
+  }
+
+  /**
+    @brief Output graph in graphviz dot format to an OutputBuffer, e.g.
+           OutputBuffer(fd) for a file descriptor. With nthreads > 1 the
+           nodes are formatted in parallel chunks (see graph_transform());
+           the output is the same.
+  */
+  template<typename GRAPH>
+  void graph_as_dot(const GRAPH& g,
+                    OutputBuffer& out,
+                    unsigned nthreads = 1)
+  {
+    GraphDotOutputter<typename GRAPH::GraphEdge> dot_outputter(out);
+    graph_transform(g,dot_outputter,nthreads);
+  }
+
+  /// Output graph as a tab-separated edge list (see GraphTsvOutputter)
+  template<typename GRAPH>
+  void graph_as_tsv(const GRAPH& g,
+                    std::ostream& o)
+  {
+    GraphTsvOutputter<typename GRAPH::GraphEdge> tsv_outputter(o);
+    graph_transform(g,tsv_outputter);
+  }
+
+  /// Same as above with names for nodes and labels (see graph_as_dot())
+  template<typename GRAPH, typename NAMES>
+  void graph_as_tsv(const GRAPH& g,
+                    std::ostream& o,
+                    const NAMES& names)
+  {
+    GraphTsvOutputter<typename GRAPH::GraphEdge,const NAMES&> tsv_outputter(o,names);
+    graph_transform(g,tsv_outputter);
+  }
+
+  /// Output graph as a tab-separated edge list to an OutputBuffer, with
+  /// nthreads formatting threads
+  template<typename GRAPH>
+  void graph_as_tsv(const GRAPH& g,
+                    OutputBuffer& out,
+                    unsigned nthreads = 1)
+  {
+    GraphTsvOutputter<typename GRAPH::GraphEdge> tsv_outputter(out);
+    graph_transform(g,tsv_outputter,nthreads);
+  }
+
 } // namespace MyCoolGraphLibrary
 
 #endif
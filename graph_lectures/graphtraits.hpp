@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////////
+// graphtraits.hpp
+// Compile-time properties of graph and edge types
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __GRAPHTRAITS_HPP__
+#define __GRAPHTRAITS_HPP__
+
+#include <type_traits>
+#include <cstdint>
+
+namespace MyCoolGraphLibrary {
+
+  /**
+    @brief is_dense_graph<GRAPH>::value is true for graph types which number
+           their nodes 0..n-1 and store their edges in contiguous arrays
+           (see compressedgraph.hpp). The search algorithms use this to
+           switch to implementations working on the dense node ids.
+  */
+  template<typename GRAPH>
+  struct is_dense_graph
+  {
+    static const bool value = false;
+  };
+
+  namespace detail {
+    /// Helper for detecting a weight() member function in an edge type
+    template<typename GRAPHEDGE>
+    class has_weight_member
+    {
+      template<typename E> static char test(decltype(&E::weight));
+      template<typename E> static long test(...);
+    public:
+      static const bool value = (sizeof(test<GRAPHEDGE>(0)) == sizeof(char));
+    };
+
+    template<typename GRAPHEDGE, bool WEIGHTED>
+    struct edge_weight_impl
+    {
+      typedef typename GRAPHEDGE::Weight Weight;
+      static Weight get(const GRAPHEDGE& e) { return e.weight(); }
+    };
+
+    template<typename GRAPHEDGE>
+    struct edge_weight_impl<GRAPHEDGE,false>
+    {
+      // Unweighted edges count as 1, just like WeightedGraphEdge's default
+      typedef unsigned int Weight;
+      static Weight get(const GRAPHEDGE&) { return 1; }
+    };
+  } // namespace detail
+
+  /**
+    @brief edge_traits<GRAPHEDGE> tells whether an edge type carries a weight
+           and gives uniform access to it. Edges without a weight() member
+           have weight 1.
+  */
+  template<typename GRAPHEDGE>
+  struct edge_traits
+  {
+    static const bool has_weight = detail::has_weight_member<GRAPHEDGE>::value;
+    typedef detail::edge_weight_impl<GRAPHEDGE,has_weight> Impl;
+    typedef typename Impl::Weight Weight;
+
+    static Weight weight(const GRAPHEDGE& e) { return Impl::get(e); }
+  };
+
+  /// Returns the weight of edge e, or 1 if its type has no weight
+  template<typename GRAPHEDGE>
+  typename edge_traits<GRAPHEDGE>::Weight edge_weight(const GRAPHEDGE& e)
+  {
+    return edge_traits<GRAPHEDGE>::weight(e);
+  }
+
+  namespace detail {
+    /// Builds an edge of type GRAPHEDGE from its parts; unweighted edge
+    /// types ignore the weight
+    template<typename GRAPHEDGE, bool WEIGHTED = edge_traits<GRAPHEDGE>::has_weight>
+    struct edge_maker
+    {
+      template<typename NODE, typename LABEL, typename WEIGHT>
+      static GRAPHEDGE make(const NODE& s, const LABEL& l, const NODE& t, const WEIGHT& w)
+      {
+        return GRAPHEDGE(s,l,t,w);
+      }
+    };
+
+    template<typename GRAPHEDGE>
+    struct edge_maker<GRAPHEDGE,false>
+    {
+      template<typename NODE, typename LABEL, typename WEIGHT>
+      static GRAPHEDGE make(const NODE& s, const LABEL& l, const NODE& t, const WEIGHT&)
+      {
+        return GRAPHEDGE(s,l,t);
+      }
+    };
+  } // namespace detail
+
+  /**
+    @brief distance_traits<WEIGHT>::Distance is the type used for path
+           lengths over edges of weight type WEIGHT. Sums of small integer
+           weights easily overflow the weight type itself, so integers
+           narrower than 32 bits are widened to 32 bits.
+  */
+  template<typename WEIGHT>
+  struct distance_traits
+  {
+    typedef typename std::conditional<
+      std::is_integral<WEIGHT>::value && (sizeof(WEIGHT) < 4),
+      typename std::conditional<std::is_unsigned<WEIGHT>::value,std::uint32_t,std::int32_t>::type,
+      WEIGHT>::type Distance;
+  };
+
+} // namespace MyCoolGraphLibrary
+
+#endif
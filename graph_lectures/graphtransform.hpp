@@ -7,26 +7,142 @@
 #ifndef __GRAPHTRANSFORM_HPP__
 #define __GRAPHTRANSFORM_HPP__
 
+#include <vector>
+#include <iterator>
+#include <type_traits>
+
 #include "labeledgraph.hpp"
+#include "graphtraits.hpp"
+#include "parallel.hpp"
 
 namespace MyCoolGraphLibrary {
 
+  namespace detail {
+
+    /// Generic graphs: one operator[] lookup per node
+    template<typename GRAPH, typename ITERATOR, typename FUNC>
+    void for_each_node(const GRAPH& g, ITERATOR first, ITERATOR last, FUNC& f, std::false_type)
+    {
+      for (auto n = first; n != last; ++n) {
+        f(*n,g[*n]);
+      }
+    }
+
+    /// Dense graphs: the position in the node range is the node id
+    template<typename GRAPH, typename ITERATOR, typename FUNC>
+    void for_each_node(const GRAPH& g, ITERATOR first, ITERATOR last, FUNC& f, std::true_type)
+    {
+      for (auto n = first; n != last; ++n) {
+        f(*n,g.edges(typename GRAPH::NodeId(n - g.nodes().begin())));
+      }
+    }
+
+    /// Calls f(node,edges) for the nodes in [first,last) of g.nodes()
+    template<typename GRAPH, typename ITERATOR, typename FUNC>
+    void for_each_node(const GRAPH& g, ITERATOR first, ITERATOR last, FUNC& f)
+    {
+      for_each_node(g,first,last,f,std::integral_constant<bool,is_dense_graph<GRAPH>::value>());
+    }
+
+    /// LabeledDirectedGraph walks its node set and adjacency map together
+    template<typename GRAPHEDGE, typename STORAGE, typename ITERATOR, typename FUNC>
+    void for_each_node(const LabeledDirectedGraph<GRAPHEDGE,STORAGE>& g,
+                       ITERATOR first, ITERATOR last, FUNC& f)
+    {
+      g.for_each_node(first,last,f);
+    }
+
+    /// Passes a node and its leaving edges to a transformer
+    template<typename TRANSFORMER>
+    struct TransformNode
+    {
+      TransformNode(TRANSFORMER& t) : transform(t) {}
+
+      template<typename NODE, typename EDGES>
+      void operator()(const NODE& node, const EDGES& neighbours)
+      {
+        // Transform node
+        transform(node);
+        // Iterate over all leaving edges
+        for (auto e = neighbours.begin(); e != neighbours.end(); ++e) {
+          transform(*e);
+        }
+      }
+
+      TRANSFORMER& transform;
+    };
+
+  } // namespace detail
+
   /// Transform a graph into some other representation
-  template<typename GRAPHEDGE, typename TRANSFORMER>
-  void graph_transform(const LabeledDirectedGraph<GRAPHEDGE>& g, 
+  /// GRAPH is LabeledDirectedGraph or any graph type with the same
+  /// nodes() and operator[] interface, e.g. CompressedGraph
+  template<typename GRAPH, typename TRANSFORMER>
+  void graph_transform(const GRAPH& g,
                        TRANSFORMER& transform)
   {
     transform.prolog();
-    // Iterate over all nodes
-    for (auto n = g.nodes().begin(); n != g.nodes().end(); ++n) {
-      // Transform node
-      transform(*n);
-      // Transform edges
-      auto& neighbours = g[*n];
-      // Iterate over all leaving edges
-      for (auto e = neighbours.begin(); e != neighbours.end(); ++e) {
-        transform(*e);
+    // Iterate over all nodes and their edges
+    detail::TransformNode<TRANSFORMER> transform_node(transform);
+    detail::for_each_node(g,g.nodes().begin(),g.nodes().end(),transform_node);
+    transform.epilog();
+  }
+
+  /**
+    @brief Same as above on nthreads threads. The nodes are split into
+           nthreads contiguous chunks. Each chunk is transformed by its own
+           worker, which the transformer creates with clone(); afterwards
+           transform.merge(worker) is called for the workers in the order
+           of the chunks, between prolog() and epilog(). So the result is
+           the same as that of the sequential version if merge() appends
+           the worker's result. TRANSFORMER additionally needs
+           - TRANSFORMER clone() const: a worker which keeps its results
+             to itself (e.g. writes into a buffer of its own)
+           - void merge(TRANSFORMER& worker): takes over the results
+           Workers only get nodes and edges, no prolog() and epilog().
+  */
+  template<typename GRAPH, typename TRANSFORMER>
+  void graph_transform(const GRAPH& g,
+                       TRANSFORMER& transform,
+                       unsigned nthreads)
+  {
+    typedef typename std::decay<decltype(g.nodes().begin())>::type NodeIterator;
+    const std::size_t n = g.nodes().size();
+    if (nthreads > n) nthreads = unsigned(n);
+    if (nthreads <= 1) {
+      graph_transform(g,transform);
+      return;
+    }
+
+    // Chunk boundaries (one walk over the nodes for node sets without
+    // random access)
+    std::vector<NodeIterator> bounds;
+    bounds.reserve(nthreads + 1);
+    NodeIterator it = g.nodes().begin();
+    std::size_t pos = 0;
+    for (unsigned t = 0; t < nthreads; ++t) {
+      std::size_t b = detail::chunk_begin(n,t,nthreads);
+      std::advance(it,b - pos);
+      pos = b;
+      bounds.push_back(it);
+    }
+    bounds.push_back(g.nodes().end());
+
+    std::vector<TRANSFORMER> workers;
+    workers.reserve(nthreads);
+    for (unsigned t = 0; t < nthreads; ++t) {
+      workers.push_back(transform.clone());
+    }
+
+    transform.prolog();
+    detail::parallel_for(nthreads,nthreads,[&](std::size_t b, std::size_t e, unsigned) {
+      for (std::size_t c = b; c < e; ++c) {
+        detail::TransformNode<TRANSFORMER> transform_node(workers[c]);
+        detail::for_each_node(g,bounds[c],bounds[c+1],transform_node);
       }
+    });
+    for (auto w = workers.begin(); w != workers.end(); ++w) {
+      transform.merge(*w);
     }
     transform.epilog();
   }
@@ -0,0 +1,353 @@
+////////////////////////////////////////////////////////////////////////////////
+// graphview.hpp
+// Filtered, induced and reversed views of graphs without copying
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __GRAPHVIEW_HPP__
+#define __GRAPHVIEW_HPP__
+
+#include <set>
+#include <iterator>
+#include <utility>
+#include <cstddef>
+
+#include "labeledgraph.hpp"
+#include "graphtraits.hpp"
+
+namespace MyCoolGraphLibrary {
+
+  namespace detail {
+    /// Predicate accepting everything
+    struct AcceptAll
+    {
+      template<typename T>
+      bool operator()(const T&) const { return true; }
+    };
+
+    /// Predicate accepting the nodes of a set
+    template<typename NODESET>
+    struct InNodeSet
+    {
+      InNodeSet(const NODESET& s) : nodes(&s) {}
+      template<typename NODE>
+      bool operator()(const NODE& n) const { return nodes->find(n) != nodes->end(); }
+      const NODESET* nodes;
+    };
+  }
+
+  /**
+    @brief FilteredGraph is a view of a graph (LabeledDirectedGraph or
+           another view) which only shows the nodes n with node_pred(n)
+           and, among the edges between them, the edges e with
+           edge_pred(e). Nothing is copied: the predicates are applied
+           while nodes() and operator[] are iterated, so a view costs no
+           memory and no build time, but every access pays for the
+           predicates. The graph and the view must outlive the ranges
+           handed out.
+           The view has the nodes() and operator[] interface of
+           LabeledDirectedGraph and can be passed to
+           breadth_first_search(), depth_first_search(), distance_search()
+           and graph_transform(), which use their generic versions.
+           Like there, a start node outside the view is visited alone.
+  */
+  template<typename GRAPH, typename NODEPRED = detail::AcceptAll,
+           typename EDGEPRED = detail::AcceptAll>
+  class FilteredGraph
+  {
+  public: // Types
+    typedef typename GRAPH::GraphEdge   GraphEdge;
+    typedef typename GRAPH::Node        Node;
+    typedef typename GRAPH::Label       Label;
+
+  private: // Types
+    typedef decltype(std::declval<const GRAPH&>().nodes().begin())  BaseNodeIterator;
+    typedef decltype(std::declval<const GRAPH&>()[std::declval<Node>()].begin()) BaseEdgeIterator;
+
+  public: // Types
+    /// Iterator over the nodes of the view
+    class NodeIterator
+    {
+    public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef Node                      value_type;
+      typedef std::ptrdiff_t            difference_type;
+      typedef const Node*               pointer;
+      typedef const Node&               reference;
+
+      NodeIterator(const FilteredGraph* v, BaseNodeIterator it, BaseNodeIterator end)
+      : view(v), cur(it), last(end) { skip(); }
+
+      const Node& operator*()  const { return *cur; }
+      const Node* operator->() const { return &*cur; }
+      NodeIterator& operator++() { ++cur; skip(); return *this; }
+      NodeIterator operator++(int) { NodeIterator it(*this); ++*this; return it; }
+      bool operator==(const NodeIterator& it) const { return cur == it.cur; }
+      bool operator!=(const NodeIterator& it) const { return cur != it.cur; }
+
+    private:
+      /// Moves to the next node of the view
+      void skip()
+      {
+        while (cur != last && !view->node_pred(*cur)) ++cur;
+      }
+
+      const FilteredGraph* view;
+      BaseNodeIterator cur, last;
+    }; // NodeIterator
+
+    /// The nodes of the view, returned by nodes()
+    class NodeRange
+    {
+    public:
+      NodeRange(const FilteredGraph* v) : view(v) {}
+
+      NodeIterator begin() const
+      {
+        return NodeIterator(view,view->graph.nodes().begin(),view->graph.nodes().end());
+      }
+      NodeIterator end() const
+      {
+        return NodeIterator(view,view->graph.nodes().end(),view->graph.nodes().end());
+      }
+
+      /// Finds node n; end() if it is not in the view
+      NodeIterator find(const Node& n) const
+      {
+        if (!view->node_pred(n)) return end();
+        return NodeIterator(view,view->graph.nodes().find(n),view->graph.nodes().end());
+      }
+
+      /// Number of nodes (counts them)
+      std::size_t size() const { return std::distance(begin(),end()); }
+      bool empty() const { return begin() == end(); }
+
+    private:
+      const FilteredGraph* view;
+    }; // NodeRange
+
+    /// Iterator over the leaving edges of a node which are in the view
+    class EdgeIterator
+    {
+    public:
+      EdgeIterator(const FilteredGraph* v, BaseEdgeIterator it, BaseEdgeIterator end)
+      : view(v), cur(it), last(end) { skip(); }
+
+      decltype(*std::declval<BaseEdgeIterator>()) operator*() const { return *cur; }
+      decltype(&*std::declval<BaseEdgeIterator>()) operator->() const { return &*cur; }
+      EdgeIterator& operator++() { ++cur; skip(); return *this; }
+      bool operator==(const EdgeIterator& it) const { return cur == it.cur; }
+      bool operator!=(const EdgeIterator& it) const { return cur != it.cur; }
+
+    private:
+      /// Moves to the next edge of the view
+      void skip()
+      {
+        while (cur != last && !view->has_edge(*cur)) ++cur;
+      }
+
+      const FilteredGraph* view;
+      BaseEdgeIterator cur, last;
+    }; // EdgeIterator
+
+    /// The leaving edges of a node, returned by operator[]
+    class EdgeRange
+    {
+    public:
+      EdgeRange(const FilteredGraph* v, BaseEdgeIterator b, BaseEdgeIterator e)
+      : view(v), first(b), last(e) {}
+
+      EdgeIterator begin() const { return EdgeIterator(view,first,last); }
+      EdgeIterator end()   const { return EdgeIterator(view,last,last); }
+      bool empty() const { return begin() == end(); }
+
+    private:
+      const FilteredGraph* view;
+      BaseEdgeIterator first, last;
+    }; // EdgeRange
+
+  public:
+    /// View of g with the predicates node_pred and edge_pred
+    FilteredGraph(const GRAPH& g, const NODEPRED& np = NODEPRED(),
+                  const EDGEPRED& ep = EDGEPRED())
+    : graph(g), node_pred(np), edge_pred(ep) {}
+
+    /// The nodes of the view
+    NodeRange nodes() const { return NodeRange(this); }
+
+    /// The edges of the view leaving node n (none if n is not in the view)
+    EdgeRange operator[](const Node& n) const
+    {
+      const auto& neighbours = graph[n];
+      if (!node_pred(n))
+        return EdgeRange(this,neighbours.end(),neighbours.end());
+      return EdgeRange(this,neighbours.begin(),neighbours.end());
+    }
+
+    /// The underlying graph
+    const GRAPH& base() const { return graph; }
+
+  private:
+    /// Is edge e of the graph in the view?
+    template<typename EDGE>
+    bool has_edge(const EDGE& e) const
+    {
+      return node_pred(e.target()) && edge_pred(e);
+    }
+
+  private:
+    const GRAPH& graph;
+    NODEPRED node_pred;   ///< Which nodes are in the view
+    EDGEPRED edge_pred;   ///< Which edges between them are in the view
+  }; // FilteredGraph
+
+
+  namespace detail {
+    /**
+      @brief An edge seen backwards: source() and target() are swapped.
+             It has a weight() only if the edge has one, so that
+             edge_traits treats it like the edge.
+    */
+    template<typename EDGE, bool WEIGHTED = edge_traits<EDGE>::has_weight>
+    class ReversedEdge
+    {
+    public:
+      typedef typename EDGE::Node   Node;
+      typedef typename EDGE::Label  Label;
+
+      ReversedEdge(const EDGE* e = 0) : edge(e) {}
+
+      const Node&  source() const { return edge->target(); }
+      const Node&  target() const { return edge->source(); }
+      const Label& label()  const { return edge->label(); }
+
+    protected:
+      const EDGE* edge;
+    };
+
+    template<typename EDGE>
+    class ReversedEdge<EDGE,true> : public ReversedEdge<EDGE,false>
+    {
+    public:
+      typedef typename EDGE::Weight Weight;
+
+      ReversedEdge(const EDGE* e = 0) : ReversedEdge<EDGE,false>(e) {}
+
+      Weight weight() const { return this->edge->weight(); }
+    };
+  }
+
+  /**
+    @brief ReversedGraph is a view of a graph with all edges turned
+           around: operator[](n) yields the edges entering n in the graph,
+           as edges from n to their source. The graph must keep an index
+           of its incoming edges, e.g. LabeledDirectedGraph after
+           index_in_edges(); otherwise operator[] throws std::logic_error.
+           Like FilteredGraph, it can be passed to the search algorithms
+           and graph_transform(), and it can be filtered itself. For a
+           reversed copy, see graph_reverse().
+  */
+  template<typename GRAPH>
+  class ReversedGraph
+  {
+  public: // Types
+    typedef typename GRAPH::GraphEdge   GraphEdge;
+    typedef typename GRAPH::Node        Node;
+    typedef typename GRAPH::Label       Label;
+
+  private: // Types
+    typedef typename std::decay<decltype(std::declval<const GRAPH&>().in_edges(std::declval<Node>()))>::type
+            InEdges;
+    typedef typename InEdges::const_iterator                    BaseEdgeIterator;
+    typedef detail::ReversedEdge<typename InEdges::value_type>  Edge;
+
+  public: // Types
+    /// Iterator over the reversed edges of a node
+    class EdgeIterator
+    {
+    public:
+      EdgeIterator(BaseEdgeIterator it) : cur(it) {}
+
+      const Edge& operator*()  const { edge = Edge(&*cur); return edge; }
+      const Edge* operator->() const { return &**this; }
+      EdgeIterator& operator++() { ++cur; return *this; }
+      bool operator==(const EdgeIterator& it) const { return cur == it.cur; }
+      bool operator!=(const EdgeIterator& it) const { return cur != it.cur; }
+
+    private:
+      BaseEdgeIterator cur;
+      mutable Edge edge;    ///< View of *cur
+    }; // EdgeIterator
+
+    /// The reversed edges of a node, returned by operator[]
+    class EdgeRange
+    {
+    public:
+      EdgeRange(const InEdges& e) : in_edges(&e) {}
+
+      EdgeIterator begin() const { return EdgeIterator(in_edges->begin()); }
+      EdgeIterator end()   const { return EdgeIterator(in_edges->end()); }
+      std::size_t  size()  const { return in_edges->size(); }
+      bool         empty() const { return in_edges->empty(); }
+
+    private:
+      const InEdges* in_edges;
+    }; // EdgeRange
+
+  public:
+    /// Reversed view of g
+    ReversedGraph(const GRAPH& g) : graph(g) {}
+
+    /// The nodes, the same as those of the graph
+    decltype(auto) nodes() const { return graph.nodes(); }
+
+    /// The edges entering n in the graph, from n to their source
+    EdgeRange operator[](const Node& n) const { return EdgeRange(graph.in_edges(n)); }
+
+    /// The underlying graph
+    const GRAPH& base() const { return graph; }
+
+  private:
+    const GRAPH& graph;
+  }; // ReversedGraph
+
+
+  /// View of g with the nodes n for which node_pred(n) holds and the edges
+  /// e between them for which edge_pred(e) holds
+  template<typename GRAPH, typename NODEPRED, typename EDGEPRED>
+  FilteredGraph<GRAPH,NODEPRED,EDGEPRED> filtered_graph(const GRAPH& g,
+                                                        const NODEPRED& node_pred,
+                                                        const EDGEPRED& edge_pred)
+  {
+    return FilteredGraph<GRAPH,NODEPRED,EDGEPRED>(g,node_pred,edge_pred);
+  }
+
+  /// View of g with all nodes and the edges e for which edge_pred(e)
+  /// holds, e.g. [](const auto& e) { return e.weight() <= 10; }
+  template<typename GRAPH, typename EDGEPRED>
+  FilteredGraph<GRAPH,detail::AcceptAll,EDGEPRED> edge_filtered_graph(const GRAPH& g,
+                                                                      const EDGEPRED& edge_pred)
+  {
+    return FilteredGraph<GRAPH,detail::AcceptAll,EDGEPRED>(g,detail::AcceptAll(),edge_pred);
+  }
+
+  /// Subgraph of g induced by the nodes in the set s (any container with
+  /// find(), e.g. std::set or std::unordered_set): these nodes and all
+  /// edges between them. The set is not copied.
+  template<typename GRAPH, typename NODESET>
+  FilteredGraph<GRAPH,detail::InNodeSet<NODESET> > induced_subgraph(const GRAPH& g,
+                                                                    const NODESET& s)
+  {
+    return FilteredGraph<GRAPH,detail::InNodeSet<NODESET> >(g,detail::InNodeSet<NODESET>(s));
+  }
+
+  /// Reversed view of g (see ReversedGraph)
+  template<typename GRAPH>
+  ReversedGraph<GRAPH> reversed_graph(const GRAPH& g)
+  {
+    return ReversedGraph<GRAPH>(g);
+  }
+
+} // namespace MyCoolGraphLibrary
+
+#endif
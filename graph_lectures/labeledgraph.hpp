@@ -14,50 +14,174 @@
 #include <vector>
 #include <iostream>
 #include <string>
+#include <stdexcept>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+
+#include "graphtraits.hpp"
+#include "edgestorage.hpp"
 
 // Separate name space for the library
 namespace MyCoolGraphLibrary {
 
+template<typename GRAPHEDGE> class GraphBuilder;
+
 /** 
   @brief LabeledDirectedGraph represents a labeled directed graph
-         templated on the edge type
+         templated on the edge type. The STORAGE policy decides what is
+         kept in the adjacency lists (see edgestorage.hpp).
+         Optionally the graph also keeps the incoming edges of every node
+         (see index_in_edges()), so that backward searches need no
+         reversed copy of the graph.
+         All containers of the graph use the allocator of the storage
+         policy (Storage::Allocator). With std::pmr::polymorphic_allocator
+         (see pmr::LabeledDirectedGraph below) a graph can live in a
+         memory resource, e.g. a std::pmr::monotonic_buffer_resource
+         which releases all of it at once. Nodes and labels which
+         allocate themselves (like std::string) still use their own
+         allocator.
 */
-template<typename GRAPHEDGE>
+template<typename GRAPHEDGE, typename STORAGE = FullEdgeStorage<GRAPHEDGE> >
 class LabeledDirectedGraph 
 {
 public: // Types
   typedef GRAPHEDGE                         GraphEdge;
+  typedef STORAGE                           Storage;
   // Note: 'typename' is necessary if a nested type is addressed
   // within a template context
   typedef typename GraphEdge::Node          Node;
   typedef typename GraphEdge::Label         Label;
-  typedef std::vector<GraphEdge>            EdgeVector;
+  typedef typename Storage::EdgeVector      EdgeVector;
+  typedef typename Storage::EdgeRef         EdgeRef;
+  typedef typename Storage::EdgeRange       EdgeRange;
+  typedef typename Storage::Allocator       Allocator;
+
+private: // Types
+  /// The allocator for elements of type T
+  template<typename T>
+  using AllocatorFor = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+public: // Types
+  typedef std::vector<GraphEdge,AllocatorFor<GraphEdge> > InEdgeVector;
 
 private: // Types
-  typedef std::set<Node>                    NodeSet;  // or unordered_set
-  typedef std::map<Node,EdgeVector>         GraphMap; // or unordered_map
+  typedef std::set<Node,std::less<Node>,AllocatorFor<Node> >  NodeSet;  // or unordered_set
+  typedef std::map<Node,EdgeVector,std::less<Node>,
+                   AllocatorFor<std::pair<const Node,EdgeVector> > > GraphMap; // or unordered_map
+  typedef std::map<Node,InEdgeVector,std::less<Node>,
+                   AllocatorFor<std::pair<const Node,InEdgeVector> > > InEdgeMap;
+
+public: // Types
+  typedef typename NodeSet::const_iterator  NodeIterator;
 
 public:
+  /// Constructor
+  LabeledDirectedGraph() : m_index_in_edges(false) {}
+
+  /// Constructor of a graph using allocator a, e.g. a memory resource for
+  /// pmr::LabeledDirectedGraph
+  explicit LabeledDirectedGraph(const Allocator& a)
+  : m_matrix(typename GraphMap::allocator_type(a)), m_nodes(typename NodeSet::allocator_type(a)),
+    m_in_edges(typename InEdgeMap::allocator_type(a)), m_index_in_edges(false) {}
+
+  /// The allocator of the graph
+  Allocator get_allocator() const { return Allocator(m_nodes.get_allocator()); }
+
   /// Add an edge src --label--> tgt
   void add(const GraphEdge& e) 
   {
     m_nodes.insert(e.source());
     m_nodes.insert(e.target());
-    // We simply add the complete edge to the adjacency list of the source
-    // This is not very memory efficient, but does the job for the moment
-    m_matrix[e.source()].push_back(e);
+    if (m_index_in_edges) m_in_edges[e.target()].push_back(e);
+    // The storage policy decides how much of the edge is kept in the
+    // adjacency list of the source
+    m_matrix[e.source()].push_back(Storage::entry(e));
+  }
+
+  /**
+    @brief Switches the index of incoming edges on or off. Switching it on
+           builds it from the edges added so far (one pass over all
+           edges); from then on add() keeps it up to date. The index holds
+           a copy of every edge, so it doubles the memory for the edges.
+  */
+  void index_in_edges(bool on = true)
+  {
+    m_index_in_edges = on;
+    m_in_edges.clear();
+    if (on) build_in_edges();
+  }
+
+  /**
+    @brief Moves all edges and nodes of other into this graph and leaves
+           other empty. The adjacency lists of other are appended as a
+           whole, so this costs one map operation per node instead of one
+           per edge like add(). If the graphs have different allocators
+           (e.g. other memory resources), the edges are moved one by one.
+  */
+  void append(LabeledDirectedGraph&& other)
+  {
+    m_nodes.insert(other.m_nodes.begin(),other.m_nodes.end());
+    for (auto n = other.m_matrix.begin(); n != other.m_matrix.end(); ++n) {
+      if (m_index_in_edges) index_edges(n->first,n->second);
+      EdgeVector& v = m_matrix[n->first];
+      if (v.empty() && v.get_allocator() == n->second.get_allocator()) v.swap(n->second);
+      else v.insert(v.end(),std::make_move_iterator(n->second.begin()),
+                    std::make_move_iterator(n->second.end()));
+    }
+    other.m_matrix.clear();
+    other.m_nodes.clear();
+    other.m_in_edges.clear();
+  }
+
+  /**
+    @brief Calls f(node,edges) for the nodes in [first,last) of nodes() in
+           order, with the range of their leaving edges as operator[]
+           returns it. The node set and the adjacency map are walked side
+           by side, so there is only one lookup for the whole range.
+  */
+  template<typename FUNC>
+  void for_each_node(NodeIterator first, NodeIterator last, FUNC& f) const
+  {
+    static EdgeVector no_neighbours;
+    // Every source is in the node set and both are sorted the same way
+    auto adj = (first != last) ? m_matrix.lower_bound(*first) : m_matrix.end();
+    for (auto n = first; n != last; ++n) {
+      if (adj != m_matrix.end() && !(*n < adj->first)) {
+        f(*n,Storage::range(adj->first,adj->second));
+        ++adj;
+      }
+      else {
+        f(*n,Storage::range(*n,no_neighbours));
+      }
+    }
+  }
+
+  /// Is the index of incoming edges kept?
+  bool has_in_edge_index() const { return m_index_in_edges; }
+
+  /// The edges entering node n in the order they were added (source()
+  /// is the predecessor); needs the index, see index_in_edges()
+  const InEdgeVector& in_edges(const Node& n) const
+  {
+    static InEdgeVector no_neighbours;
+    if (!m_index_in_edges)
+      throw std::logic_error("in_edges() needs the index of incoming edges");
+    auto it = m_in_edges.find(n);
+    return (it != m_in_edges.end()) ? it->second : no_neighbours;
   }
 
   /// Access to the adjacency vector of node n
-  /// Note: currently not very good since we're exposing implementation details
-  /// A better idea would be an iterator
-  const EdgeVector& operator[](const Node& n) const
+  /// With FullEdgeStorage this is a const reference to the vector of edges,
+  /// with other policies a range of light-weight edge views
+  EdgeRange operator[](const Node& n) const
   { 
     // static trick!
     static EdgeVector no_neighbours;
     auto it = m_matrix.find(n);
-    // By returning a const reference, we avoid copying
-    return (it != m_matrix.end()) ? it->second : no_neighbours;
+    // By returning a const reference (or a view), we avoid copying
+    return (it != m_matrix.end()) ? Storage::range(it->first,it->second) 
+                                  : Storage::range(n,no_neighbours);
   }
 
   /// Accessor for node set
@@ -71,6 +195,28 @@ public:
   }
 
 private: // Functions
+  // The bulk builder fills m_matrix and m_nodes directly
+  template<typename E> friend class GraphBuilder;
+
+  /// Fills the index of incoming edges from the adjacency lists
+  void build_in_edges()
+  {
+    for (auto n = m_matrix.begin(); n != m_matrix.end(); ++n) {
+      index_edges(n->first,n->second);
+    }
+  }
+
+  /// Adds the edges of the adjacency vector v of src to the index of
+  /// incoming edges
+  void index_edges(const Node& src, const EdgeVector& v)
+  {
+    const auto& neighbours = Storage::range(src,v);
+    for (auto e = neighbours.begin(); e != neighbours.end(); ++e) {
+      m_in_edges[e->target()].push_back(
+        detail::edge_maker<GraphEdge>::make(e->source(),e->label(),e->target(),edge_weight(*e)));
+    }
+  }
+
   /// Print the relation of the graph
   void print(std::ostream& o) const
   {
@@ -84,9 +230,23 @@ private: // Functions
   }
     
 private:
-  GraphMap m_matrix;  ///< Maps nodes to vector of leaving edges
-  NodeSet m_nodes;    ///< Set to keep track of all used nodes. 
+  GraphMap m_matrix;        ///< Maps nodes to vector of leaving edges
+  NodeSet m_nodes;          ///< Set to keep track of all used nodes. 
+  InEdgeMap m_in_edges;     ///< Maps nodes to vector of entering edges
+  bool m_index_in_edges;    ///< Is m_in_edges kept up to date?
 }; // LabeledDirectedGraph
 
+namespace pmr {
+  /**
+    @brief LabeledDirectedGraph with a polymorphic allocator, like the
+           containers in std::pmr: pmr::LabeledDirectedGraph<E> g(&resource)
+           allocates all its nodes and edges from the memory resource.
+  */
+  template<typename GRAPHEDGE, template<typename,typename> class STORAGE = FullEdgeStorage>
+  using LabeledDirectedGraph =
+    MyCoolGraphLibrary::LabeledDirectedGraph<GRAPHEDGE,
+                                             STORAGE<GRAPHEDGE,std::pmr::polymorphic_allocator<GRAPHEDGE> > >;
+}
+
 } // namespace
 #endif
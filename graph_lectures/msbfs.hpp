@@ -0,0 +1,217 @@
+////////////////////////////////////////////////////////////////////////////////
+// msbfs.hpp
+// Bit-parallel multi-source breadth-first search (MS-BFS)
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __MSBFS_HPP__
+#define __MSBFS_HPP__
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "compressedgraph.hpp"
+
+namespace MyCoolGraphLibrary {
+
+  namespace detail {
+    template<typename GRAPH, unsigned WORDS> class MultiSourceBFS;
+  }
+
+  /**
+    @brief multi_source_breadth_first_search() runs one BFS from each of
+           the given start nodes. The searches are done in batches of
+           64*WORDS sources, which share every scan of an adjacency list.
+    @param g the graph (a dense graph like CompressedGraph)
+    @param starts the start nodes
+    @param visitor called as visitor(i,node,level) when the search from
+           starts[i] reaches node at the given level (the start itself at
+           level 0). Calls come level by level within a batch.
+    @tparam WORDS number of 64 bit words per node mask (1 to 4 are sensible)
+  */
+  template<unsigned WORDS = 1, typename GRAPH, typename VISITOR>
+  void multi_source_breadth_first_search(const GRAPH& g,
+                                         const std::vector<typename GRAPH::Node>& starts,
+                                         VISITOR& visitor)
+  {
+    typedef detail::MultiSourceBFS<GRAPH,WORDS> Search;
+    Search bfs_algorithm(g);
+    std::vector<typename GRAPH::NodeId> ids;
+    for (std::size_t b = 0; b < starts.size(); b += Search::batch_size) {
+      std::size_t e = std::min(b + Search::batch_size,starts.size());
+      ids.clear();
+      for (std::size_t i = b; i < e; ++i) ids.push_back(g.id(starts[i]));
+      bfs_algorithm.search(ids,[&](std::size_t i, typename GRAPH::NodeId v, std::uint32_t level) {
+        visitor(b + i,g.node(v),level);
+      });
+    }
+  }
+
+  /**
+    @brief multi_source_bfs_levels() computes the BFS levels of all node ids
+           from each of the given start nodes.
+    @return row-major matrix with one row of g.no_of_nodes() levels per
+            start node; std::uint32_t(-1) for unreachable nodes
+  */
+  template<unsigned WORDS = 1, typename GRAPH>
+  std::vector<std::uint32_t> multi_source_bfs_levels(const GRAPH& g,
+                                                     const std::vector<typename GRAPH::Node>& starts)
+  {
+    typedef detail::MultiSourceBFS<GRAPH,WORDS> Search;
+    const std::size_t n = g.no_of_nodes();
+    std::vector<std::uint32_t> level(starts.size() * n,std::uint32_t(-1));
+    Search bfs_algorithm(g);
+    std::vector<typename GRAPH::NodeId> ids;
+    for (std::size_t b = 0; b < starts.size(); b += Search::batch_size) {
+      std::size_t e = std::min(b + Search::batch_size,starts.size());
+      ids.clear();
+      for (std::size_t i = b; i < e; ++i) ids.push_back(g.id(starts[i]));
+      bfs_algorithm.search(ids,[&](std::size_t i, typename GRAPH::NodeId v, std::uint32_t d) {
+        level[(b + i) * n + v] = d;
+      });
+    }
+    return level;
+  }
+
+  namespace detail {
+
+    /// Bit mask of WORDS 64 bit words. The loops have a fixed length, so
+    /// the compiler can turn them into SIMD instructions.
+    template<unsigned WORDS>
+    struct WideMask
+    {
+      std::uint64_t w[WORDS];
+
+      void clear()                        { for (unsigned i = 0; i < WORDS; ++i) w[i] = 0; }
+      void set(std::size_t b)             { w[b >> 6] |= std::uint64_t(1) << (b & 63); }
+      bool any() const
+      {
+        std::uint64_t r = 0;
+        for (unsigned i = 0; i < WORDS; ++i) r |= w[i];
+        return r != 0;
+      }
+      WideMask& operator|=(const WideMask& m)
+      {
+        for (unsigned i = 0; i < WORDS; ++i) w[i] |= m.w[i];
+        return *this;
+      }
+      /// Bits of a which are not in b
+      static WideMask and_not(const WideMask& a, const WideMask& b)
+      {
+        WideMask r;
+        for (unsigned i = 0; i < WORDS; ++i) r.w[i] = a.w[i] & ~b.w[i];
+        return r;
+      }
+    }; // WideMask
+
+  /**
+    @brief Multi-source BFS (Then et al., "The More the Merrier") on dense
+           node ids. Every node has a mask with one bit per search of the
+           batch: seen (the searches which reached it), visit (the searches
+           for which it is in the current frontier) and next (the same for
+           the next frontier). One scan of the out-edges of a frontier node
+           advances all searches in its visit mask at once.
+  */
+  template<typename GRAPH, unsigned WORDS>
+  class MultiSourceBFS
+  {
+  public:
+    typedef typename GRAPH::NodeId      NodeId;
+    typedef typename GRAPH::EdgeIndex   EdgeIndex;
+    typedef WideMask<WORDS>             Mask;
+    typedef std::uint32_t               Level;
+
+    /// Maximal number of sources per search() call
+    static constexpr std::size_t batch_size = 64 * WORDS;
+
+  public:
+    /// Constructor; the masks are allocated once and reused by every search
+    MultiSourceBFS(const GRAPH& g)
+    : graph(g), seen(g.no_of_nodes()), visit(g.no_of_nodes()), next(g.no_of_nodes())
+    {
+      for (NodeId v = 0; v < graph.no_of_nodes(); ++v) {
+        seen[v].clear();
+        visit[v].clear();
+        next[v].clear();
+      }
+    }
+
+    /**
+      @brief Runs the searches from sources (at most batch_size ids) and
+             calls reached(i,v,level) whenever search i reaches node id v
+    */
+    template<typename REACHED>
+    void search(const std::vector<NodeId>& sources, REACHED reached)
+    {
+      for (auto v = touched.begin(); v != touched.end(); ++v) seen[*v].clear();
+      touched.clear();
+      frontier.clear();
+
+      for (std::size_t i = 0; i < sources.size() && i < batch_size; ++i) {
+        NodeId s = sources[i];
+        if (s == GRAPH::NoNode()) continue;
+        if (!visit[s].any()) {
+          frontier.push_back(s);
+          touched.push_back(s);
+        }
+        visit[s].set(i);
+        seen[s].set(i);
+      }
+      report(frontier,visit,0,reached);
+
+      for (Level depth = 1; !frontier.empty(); ++depth) {
+        next_frontier.clear();
+        for (auto u = frontier.begin(); u != frontier.end(); ++u) {
+          const Mask& active = visit[*u];
+          for (EdgeIndex e = graph.first_edge(*u); e != graph.last_edge(*u); ++e) {
+            NodeId v = graph.target(e);
+            Mask d = Mask::and_not(active,seen[v]);
+            if (!d.any()) continue;
+            if (!next[v].any()) next_frontier.push_back(v);
+            next[v] |= d;
+          }
+        }
+        // seen is only updated now, so next holds new searches only
+        for (auto u = frontier.begin(); u != frontier.end(); ++u) visit[*u].clear();
+        for (auto v = next_frontier.begin(); v != next_frontier.end(); ++v) {
+          if (!seen[*v].any()) touched.push_back(*v);
+          seen[*v] |= next[*v];
+          visit[*v] = next[*v];
+          next[*v].clear();
+        }
+        report(next_frontier,visit,depth,reached);
+        frontier.swap(next_frontier);
+      }
+    }
+
+  private:
+    /// Calls reached() for every bit of the masks of the given nodes
+    template<typename REACHED>
+    static void report(const std::vector<NodeId>& nodes, const std::vector<Mask>& masks,
+                       Level depth, REACHED& reached)
+    {
+      for (auto v = nodes.begin(); v != nodes.end(); ++v) {
+        const Mask& m = masks[*v];
+        for (unsigned i = 0; i < WORDS; ++i) {
+          for (std::uint64_t bits = m.w[i]; bits != 0; bits &= bits - 1) {
+            reached(std::size_t(i) * 64 + __builtin_ctzll(bits),*v,depth);
+          }
+        }
+      }
+    }
+
+  private: // Member variables
+    const GRAPH& graph;
+    std::vector<Mask> seen;             ///< Searches which reached each node
+    std::vector<Mask> visit;            ///< Searches with the node in their frontier
+    std::vector<Mask> next;             ///< Same for the next frontier
+    std::vector<NodeId> frontier;       ///< Nodes with a non-empty visit mask
+    std::vector<NodeId> next_frontier;  ///< Nodes with a non-empty next mask
+    std::vector<NodeId> touched;        ///< Nodes with a non-empty seen mask
+  }; // MultiSourceBFS
+
+  } // namespace detail
+} // namespace MyCoolGraphLibrary
+
+#endif
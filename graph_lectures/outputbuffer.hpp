@@ -0,0 +1,218 @@
+////////////////////////////////////////////////////////////////////////////////
+// outputbuffer.hpp
+// Large output buffer with fast number formatting for graph writers
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __OUTPUTBUFFER_HPP__
+#define __OUTPUTBUFFER_HPP__
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <charconv>
+#include <cstring>
+#include <cerrno>
+
+#include <unistd.h>
+
+namespace MyCoolGraphLibrary {
+
+  /**
+    @brief OutputBuffer collects output in one large buffer and hands it to
+           its sink (a stream or a file descriptor) only when the buffer is
+           full or flush() is called, so writing a line costs a few memcpy
+           calls instead of a stream operation per field. Numbers are
+           formatted with std::to_chars; floating point numbers like the
+           default of streams ("%g", 6 digits), characters as characters.
+           Other types go through a std::ostringstream.
+           A buffer without a sink just grows; its contents are read with
+           data() and size(), e.g. to merge the output of worker threads.
+           The destructor flushes.
+  */
+  class OutputBuffer
+  {
+  public:
+    static constexpr std::size_t default_capacity = 1 << 20;
+
+  public:
+    /// Buffer in memory without a sink; it grows as needed
+    OutputBuffer()
+    : m_stream(0), m_fd(-1), m_data(default_capacity), m_size(0)
+    {}
+
+    /// Buffer writing to stream o
+    explicit OutputBuffer(std::ostream& o, std::size_t capacity = default_capacity)
+    : m_stream(&o), m_fd(-1), m_data(capacity > 64 ? capacity : 64), m_size(0)
+    {}
+
+    /// Buffer writing to the file descriptor fd (which is not closed)
+    explicit OutputBuffer(int fd, std::size_t capacity = default_capacity)
+    : m_stream(0), m_fd(fd), m_data(capacity > 64 ? capacity : 64), m_size(0)
+    {}
+
+    ~OutputBuffer()
+    {
+      try {
+        flush();
+      }
+      catch (...) {
+        // Destructors must not throw; call flush() to see errors
+      }
+    }
+
+    /// Does the buffer have a sink?
+    bool has_sink() const { return m_stream || m_fd >= 0; }
+
+    /// The buffered bytes
+    const char* data() const { return m_data.data(); }
+    std::size_t size() const { return m_size; }
+
+    /// Drops the buffered bytes
+    void clear() { m_size = 0; }
+
+    /// Hands the buffered bytes to the sink; throws std::runtime_error if
+    /// that fails
+    void flush()
+    {
+      if (!has_sink()) return;
+      write_out(m_data.data(),m_size);
+      m_size = 0;
+      if (m_stream) m_stream->flush();
+    }
+
+    /// Appends n bytes
+    void write(const char* p, std::size_t n)
+    {
+      if (m_size + n > m_data.size()) {
+        if (has_sink()) {
+          write_out(m_data.data(),m_size);
+          m_size = 0;
+          // Large blocks go directly to the sink
+          if (n >= m_data.size()) {
+            write_out(p,n);
+            return;
+          }
+        }
+        else {
+          grow(n);
+        }
+      }
+      std::memcpy(m_data.data() + m_size,p,n);
+      m_size += n;
+    }
+
+    /// Appends a character
+    void put(char c)
+    {
+      if (m_size == m_data.size()) make_room(1);
+      m_data[m_size++] = c;
+    }
+
+    OutputBuffer& operator<<(char c)              { put(c); return *this; }
+    OutputBuffer& operator<<(signed char c)       { put(char(c)); return *this; }
+    OutputBuffer& operator<<(unsigned char c)     { put(char(c)); return *this; }
+    OutputBuffer& operator<<(bool b)              { put(b ? '1' : '0'); return *this; }
+    OutputBuffer& operator<<(const char* s)       { write(s,std::strlen(s)); return *this; }
+    OutputBuffer& operator<<(std::string_view s)  { write(s.data(),s.size()); return *this; }
+    OutputBuffer& operator<<(const std::string& s){ write(s.data(),s.size()); return *this; }
+
+    /// Integers
+    template<typename T>
+    typename std::enable_if<std::is_integral<T>::value,OutputBuffer&>::type
+    operator<<(T x)
+    {
+      make_room(max_number_length);
+      char* p = m_data.data() + m_size;
+      m_size = std::to_chars(p,p + max_number_length,x).ptr - m_data.data();
+      return *this;
+    }
+
+    /// Floating point numbers, like std::ostream with its default format
+    template<typename T>
+    typename std::enable_if<std::is_floating_point<T>::value,OutputBuffer&>::type
+    operator<<(T x)
+    {
+      make_room(max_number_length);
+      char* p = m_data.data() + m_size;
+      m_size = std::to_chars(p,p + max_number_length,x,std::chars_format::general,6).ptr
+               - m_data.data();
+      return *this;
+    }
+
+    /// Everything else, through a string stream (slow)
+    template<typename T>
+    typename std::enable_if<!std::is_arithmetic<T>::value &&
+                            !std::is_convertible<const T&,std::string_view>::value,
+                            OutputBuffer&>::type
+    operator<<(const T& x)
+    {
+      std::ostringstream s;
+      s << x;
+      return *this << s.str();
+    }
+
+  private:
+    /// Room for the longest formatted number (e.g. "-1.23457e-308")
+    static constexpr std::size_t max_number_length = 32;
+
+    /// Makes sure that n more bytes fit into the buffer
+    void make_room(std::size_t n)
+    {
+      if (m_size + n <= m_data.size()) return;
+      if (has_sink()) {
+        write_out(m_data.data(),m_size);
+        m_size = 0;
+      }
+      else {
+        grow(n);
+      }
+    }
+
+    /// Makes the buffer large enough for n more bytes
+    void grow(std::size_t n)
+    {
+      std::size_t capacity = m_data.size();
+      while (capacity < m_size + n) capacity *= 2;
+      m_data.resize(capacity);
+    }
+
+    /// Writes n bytes to the sink
+    void write_out(const char* p, std::size_t n)
+    {
+      if (n == 0) return;
+      if (m_stream) {
+        m_stream->write(p,n);
+        if (!*m_stream)
+          throw std::runtime_error("error writing to output stream");
+        return;
+      }
+      while (n > 0) {
+        ssize_t k = ::write(m_fd,p,n);
+        if (k < 0) {
+          if (errno == EINTR) continue;
+          throw std::runtime_error(std::string("error writing to file descriptor: ") +
+                                   std::strerror(errno));
+        }
+        p += k;
+        n -= std::size_t(k);
+      }
+    }
+
+  private:
+    OutputBuffer(const OutputBuffer&);
+    OutputBuffer& operator=(const OutputBuffer&);
+
+    std::ostream*     m_stream;   ///< Stream sink or 0
+    int               m_fd;       ///< File descriptor sink or -1
+    std::vector<char> m_data;     ///< The buffer
+    std::size_t       m_size;     ///< Number of buffered bytes
+  }; // OutputBuffer
+
+} // namespace MyCoolGraphLibrary
+
+#endif
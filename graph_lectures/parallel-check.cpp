@@ -0,0 +1,294 @@
+////////////////////////////////////////////////////////////////////////////////
+// parallel-check.cpp
+// Checks the parallel graph algorithms against sequential results
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+// Usage: parallel-check [number of graphs] [random seed]
+// Build: g++ -std=c++17 -O2 -pthread parallel-check.cpp -o parallel-check
+//
+// On random graphs of different density (with and without cycles) and with
+// several thread counts it compares
+// - parallel_strongly_connected_components() with
+//   strongly_connected_components() and with the components found by
+//   plain forward and backward searches,
+// - topological_levels() with itself on one thread and with the levels
+//   defined by Kahn's algorithm,
+// - parallel_bfs_levels() and parallel_breadth_first_search() with a plain
+//   queue-based BFS,
+// - multi_source_bfs_levels() with one plain BFS per source.
+// Prints the number of failed checks and returns 1 if there were any.
+
+#include <vector>
+#include <deque>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include "graphedge.hpp"
+#include "labeledgraph.hpp"
+#include "compressedgraph.hpp"
+#include "reverse.hpp"
+#include "scc.hpp"
+#include "topologicalsort.hpp"
+#include "parallelbfs.hpp"
+#include "msbfs.hpp"
+
+using MyCoolGraphLibrary::SimpleGraphEdge;
+using MyCoolGraphLibrary::LabeledDirectedGraph;
+using MyCoolGraphLibrary::CompressedGraph;
+using MyCoolGraphLibrary::ThreadPool;
+using MyCoolGraphLibrary::StronglyConnectedComponents;
+using MyCoolGraphLibrary::TopologicalLevels;
+
+typedef SimpleGraphEdge<unsigned,unsigned> Edge;
+typedef CompressedGraph<Edge> Graph;
+typedef Graph::NodeId NodeId;
+typedef std::vector<std::uint32_t> Levels;
+
+static const std::uint32_t unreached = std::uint32_t(-1);
+static const unsigned thread_counts[] = { 1, 2, 3, 4, 8 };
+
+static unsigned failures = 0;
+
+/// Counts and reports a failed check
+void check(bool ok, const char* what, unsigned graph_no, unsigned nthreads = 0)
+{
+  if (ok) return;
+  ++failures;
+  std::cerr << "FAILED: " << what << " (graph " << graph_no;
+  if (nthreads > 0) std::cerr << ", " << nthreads << " threads";
+  std::cerr << ")\n";
+}
+
+/// Random graph with up to n nodes and about n*degree edges; with acyclic
+/// set all edges lead to a larger node. Node i is named 1000 + 7*i, so
+/// that nodes and node ids differ.
+Graph random_graph(std::mt19937& rng, unsigned n, unsigned degree, bool acyclic)
+{
+  LabeledDirectedGraph<Edge> g;
+  g.add(Edge(1000,0,1000 + 7*(n-1)));
+  for (unsigned i = 0; i < n * degree; ++i) {
+    unsigned u = rng() % n, v = rng() % n;
+    if (acyclic && u >= v) continue;
+    g.add(Edge(1000 + 7*u,0,1000 + 7*v));
+  }
+  return Graph(g);
+}
+
+/// BFS levels of all node ids from node id s with a plain queue
+Levels plain_bfs_levels(const Graph& g, NodeId s)
+{
+  Levels level(g.no_of_nodes(),unreached);
+  std::deque<NodeId> queue;
+  level[s] = 0;
+  queue.push_back(s);
+  while (!queue.empty()) {
+    NodeId u = queue.front();
+    queue.pop_front();
+    for (auto e = g.first_edge(u); e != g.last_edge(u); ++e) {
+      NodeId v = g.target(e);
+      if (level[v] == unreached) {
+        level[v] = level[u] + 1;
+        queue.push_back(v);
+      }
+    }
+  }
+  return level;
+}
+
+/// Do both component maps describe the same partition?
+bool same_partition(const std::vector<std::uint32_t>& a, std::uint32_t ka,
+                    const std::vector<std::uint32_t>& b, std::uint32_t kb)
+{
+  if (a.size() != b.size() || ka != kb) return false;
+  std::vector<std::uint32_t> a_to_b(ka,unreached), b_to_a(kb,unreached);
+  for (std::size_t v = 0; v < a.size(); ++v) {
+    if (a[v] >= ka || b[v] >= kb) return false;
+    if (a_to_b[a[v]] == unreached) a_to_b[a[v]] = b[v];
+    if (b_to_a[b[v]] == unreached) b_to_a[b[v]] = a[v];
+    if (a_to_b[a[v]] != b[v] || b_to_a[b[v]] != a[v]) return false;
+  }
+  return true;
+}
+
+/// Are the components topologically numbered, and does the condensation
+/// count the edges between components?
+bool valid_components(const Graph& g, const StronglyConnectedComponents& scc)
+{
+  std::uint64_t between = 0;
+  for (NodeId u = 0; u < g.no_of_nodes(); ++u) {
+    for (auto e = g.first_edge(u); e != g.last_edge(u); ++e) {
+      std::uint32_t cu = scc.component[u], cv = scc.component[g.target(e)];
+      if (cu > cv) return false;
+      between += (cu != cv);
+    }
+  }
+  std::uint64_t counted = 0;
+  for (auto c = scc.condensation.label_array().begin(); c != scc.condensation.label_array().end(); ++c)
+    counted += *c;
+  return scc.condensation.no_of_nodes() == scc.no_of_components && counted == between;
+}
+
+void check_scc(const Graph& g, const Graph& g_rev, unsigned graph_no)
+{
+  // Reference: u and v share a component if each reaches the other
+  const NodeId n = g.no_of_nodes();
+  std::vector<std::uint32_t> reference(n,unreached);
+  std::uint32_t k = 0;
+  for (NodeId s = 0; s < n; ++s) {
+    if (reference[s] != unreached) continue;
+    Levels forward = plain_bfs_levels(g,s), backward = plain_bfs_levels(g_rev,s);
+    for (NodeId v = 0; v < n; ++v)
+      if (forward[v] != unreached && backward[v] != unreached) reference[v] = k;
+    ++k;
+  }
+
+  StronglyConnectedComponents seq = MyCoolGraphLibrary::strongly_connected_components(g);
+  check(same_partition(seq.component,seq.no_of_components,reference,k),
+        "sequential SCC differs from forward-backward reachability",graph_no);
+  check(valid_components(g,seq),"sequential SCC order or condensation",graph_no);
+  for (unsigned nt : thread_counts) {
+    StronglyConnectedComponents par =
+      MyCoolGraphLibrary::parallel_strongly_connected_components(g,g_rev,nt);
+    check(same_partition(par.component,par.no_of_components,seq.component,seq.no_of_components),
+          "parallel SCC differs from sequential SCC",graph_no,nt);
+    check(valid_components(g,par),"parallel SCC order or condensation",graph_no,nt);
+  }
+}
+
+void check_topological_levels(const Graph& g, const Graph& g_rev, unsigned graph_no)
+{
+  typedef TopologicalLevels<Graph> Result;
+  const NodeId n = g.no_of_nodes();
+  // Reference: the level of v is 0 without in-edges, else one more than
+  // the largest level of its predecessors; nodes with a predecessor on or
+  // behind a cycle get none
+  Levels reference(n,Result::NoLevel());
+  std::vector<NodeId> in_degree(n,0);
+  for (NodeId u = 0; u < n; ++u)
+    for (auto e = g.first_edge(u); e != g.last_edge(u); ++e) ++in_degree[g.target(e)];
+  std::deque<NodeId> ready;
+  for (NodeId v = 0; v < n; ++v) {
+    if (in_degree[v] == 0) {
+      reference[v] = 0;
+      ready.push_back(v);
+    }
+  }
+  NodeId levelled = 0;
+  while (!ready.empty()) {
+    NodeId u = ready.front();
+    ready.pop_front();
+    ++levelled;
+    for (auto e = g.first_edge(u); e != g.last_edge(u); ++e) {
+      NodeId v = g.target(e);
+      if (--in_degree[v] == 0) {
+        reference[v] = 0;
+        for (auto r = g_rev.first_edge(v); r != g_rev.last_edge(v); ++r)
+          reference[v] = std::max(reference[v],reference[g_rev.target(r)] + 1);
+        ready.push_back(v);
+      }
+    }
+  }
+
+  Result one = MyCoolGraphLibrary::topological_levels(g,1);
+  check(one.level == reference,"levels differ from Kahn's algorithm",graph_no,1);
+  check(one.acyclic() == (levelled == n),"acyclic() is wrong",graph_no,1);
+  bool grouped = one.level_begin.size() >= 1 && one.level_begin.back() == one.order.size();
+  for (std::uint32_t l = 0; grouped && l < one.no_of_levels(); ++l) {
+    for (std::size_t i = one.level_begin[l]; i < one.level_begin[l+1]; ++i)
+      grouped = grouped && one.level[one.order[i]] == l;
+  }
+  check(grouped && one.order.size() == levelled,"order does not follow the levels",graph_no,1);
+  bool cycle = true;
+  for (std::size_t i = 0; i < one.cycle.size(); ++i) {
+    NodeId u = one.cycle[i], v = one.cycle[(i+1) % one.cycle.size()];
+    bool edge = false;
+    for (auto e = g.first_edge(u); e != g.last_edge(u); ++e) edge = edge || g.target(e) == v;
+    cycle = cycle && edge;
+  }
+  check(cycle,"reported cycle is not a cycle",graph_no,1);
+
+  for (unsigned nt : thread_counts) {
+    Result par = MyCoolGraphLibrary::topological_levels(g,nt);
+    check(par.order == one.order && par.level_begin == one.level_begin &&
+          par.level == one.level && par.acyclic() == one.acyclic(),
+          "parallel levels differ from one thread",graph_no,nt);
+  }
+}
+
+/// Visitor collecting the reached nodes in the order of the calls
+struct NodeCollector
+{
+  void operator()(unsigned node) { nodes.push_back(node); }
+  std::vector<unsigned> nodes;
+};
+
+void check_bfs(const Graph& g, std::mt19937& rng, unsigned graph_no)
+{
+  const NodeId n = g.no_of_nodes();
+  for (unsigned nt : thread_counts) {
+    ThreadPool pool(nt);
+    for (int i = 0; i < 3; ++i) {
+      NodeId s = rng() % n;
+      Levels reference = plain_bfs_levels(g,s);
+      check(MyCoolGraphLibrary::parallel_bfs_levels(g,g.node(s),pool) == reference,
+            "parallel_bfs_levels differs from plain BFS",graph_no,nt);
+
+      // Every reached node once, level by level
+      NodeCollector visitor;
+      MyCoolGraphLibrary::parallel_breadth_first_search(g,g.node(s),visitor,pool);
+      std::size_t reached = std::count_if(reference.begin(),reference.end(),
+                                          [](std::uint32_t l) { return l != unreached; });
+      bool ok = visitor.nodes.size() == reached;
+      std::vector<bool> seen(n,false);
+      for (std::size_t j = 0; ok && j < visitor.nodes.size(); ++j) {
+        NodeId v = g.id(visitor.nodes[j]);
+        ok = reference[v] != unreached && !seen[v] &&
+             (j == 0 || reference[g.id(visitor.nodes[j-1])] <= reference[v]);
+        seen[v] = true;
+      }
+      check(ok,"parallel_breadth_first_search visits differ from plain BFS",graph_no,nt);
+    }
+  }
+}
+
+void check_msbfs(const Graph& g, std::mt19937& rng, unsigned graph_no)
+{
+  const NodeId n = g.no_of_nodes();
+  // More sources than fit into one batch of 64 or 128 searches
+  std::vector<unsigned> starts;
+  for (int i = 0; i < 150; ++i) starts.push_back(g.node(rng() % n));
+  Levels reference;
+  for (unsigned s : starts) {
+    Levels l = plain_bfs_levels(g,g.id(s));
+    reference.insert(reference.end(),l.begin(),l.end());
+  }
+  check(MyCoolGraphLibrary::multi_source_bfs_levels<1>(g,starts) == reference,
+        "multi_source_bfs_levels<1> differs from plain BFS",graph_no);
+  check(MyCoolGraphLibrary::multi_source_bfs_levels<2>(g,starts) == reference,
+        "multi_source_bfs_levels<2> differs from plain BFS",graph_no);
+}
+
+int main(int argc, char* argv[])
+{
+  const unsigned graphs = (argc > 1) ? std::atoi(argv[1]) : 60;
+  const unsigned seed = (argc > 2) ? std::atoi(argv[2]) : 42;
+
+  std::mt19937 rng(seed);
+  for (unsigned i = 0; i < graphs; ++i) {
+    unsigned n = 2 + rng() % 3000;
+    unsigned degree = 1 + i % 4;
+    bool acyclic = (i % 3 == 0);
+    Graph g = random_graph(rng,n,degree,acyclic);
+    Graph g_rev = MyCoolGraphLibrary::graph_reverse(g);
+    check_scc(g,g_rev,i);
+    check_topological_levels(g,g_rev,i);
+    check_bfs(g,rng,i);
+    check_msbfs(g,rng,i);
+  }
+  std::cout << graphs << " graphs, " << failures << " failed checks\n";
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,265 @@
+////////////////////////////////////////////////////////////////////////////////
+// parallel.hpp
+// Small helpers for running loops and sorts on several threads
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __PARALLEL_HPP__
+#define __PARALLEL_HPP__
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
+#include <exception>
+
+namespace MyCoolGraphLibrary {
+
+  namespace detail {
+
+    /// Number of threads to use when the caller does not say otherwise
+    inline unsigned default_concurrency()
+    {
+      unsigned n = std::thread::hardware_concurrency();
+      return (n > 0) ? n : 1;
+    }
+
+    /// Start of chunk t when [0,n) is split into nt contiguous chunks of
+    /// about the same size; chunk t is [chunk_begin(n,t,nt),chunk_begin(n,t+1,nt))
+    template<typename INDEX>
+    inline INDEX chunk_begin(INDEX n, unsigned t, unsigned nt)
+    {
+      return INDEX(std::uint64_t(n) * t / nt);
+    }
+
+    /**
+      @brief Splits [0,n) into nthreads contiguous chunks and calls
+             fn(begin,end,chunk_no) for each of them on its own thread.
+             The calling thread processes chunk 0 itself. Returns when all
+             chunks are done.
+    */
+    template<typename FUNC>
+    void parallel_for(std::size_t n, unsigned nthreads, FUNC fn)
+    {
+      if (nthreads < 1) nthreads = 1;
+      if (nthreads > n) nthreads = (n > 0) ? unsigned(n) : 1;
+      if (nthreads == 1) {
+        fn(std::size_t(0),n,0u);
+        return;
+      }
+      std::vector<std::thread> workers;
+      workers.reserve(nthreads-1);
+      for (unsigned t = 1; t < nthreads; ++t) {
+        workers.emplace_back(fn,chunk_begin(n,t,nthreads),chunk_begin(n,t+1,nthreads),t);
+      }
+      fn(std::size_t(0),chunk_begin(n,1,nthreads),0u);
+      for (auto w = workers.begin(); w != workers.end(); ++w) {
+        w->join();
+      }
+    }
+
+    /**
+      @brief Stable sort of [first,last) on nthreads threads.
+             Each thread sorts one chunk, then neighbouring chunks are merged
+             pairwise (again in parallel) until one sorted run is left.
+    */
+    template<typename ITERATOR, typename COMPARE>
+    void parallel_stable_sort(ITERATOR first, ITERATOR last, COMPARE comp, unsigned nthreads)
+    {
+      std::size_t n = std::distance(first,last);
+      // Small inputs are not worth the thread creation
+      if (nthreads <= 1 || n < 4096) {
+        std::stable_sort(first,last,comp);
+        return;
+      }
+      // Chunk boundaries
+      std::vector<std::size_t> bounds;
+      for (unsigned t = 0; t <= nthreads; ++t) {
+        bounds.push_back(chunk_begin(n,t,nthreads));
+      }
+      parallel_for(nthreads,nthreads,[&](std::size_t b, std::size_t e, unsigned) {
+        for (std::size_t c = b; c < e; ++c)
+          std::stable_sort(first + bounds[c],first + bounds[c+1],comp);
+      });
+      // Merge neighbouring runs; std::inplace_merge is stable, so the
+      // relative order of equivalent elements is kept
+      while (bounds.size() > 2) {
+        std::size_t runs = bounds.size() - 1;
+        parallel_for(runs / 2,nthreads,[&](std::size_t b, std::size_t e, unsigned) {
+          for (std::size_t r = b; r < e; ++r) {
+            std::inplace_merge(first + bounds[2*r],first + bounds[2*r+1],
+                               first + bounds[2*r+2],comp);
+          }
+        });
+        std::vector<std::size_t> merged;
+        for (std::size_t i = 0; i < bounds.size(); i += 2) {
+          merged.push_back(bounds[i]);
+        }
+        if (merged.back() != bounds.back()) merged.push_back(bounds.back());
+        bounds.swap(merged);
+      }
+    }
+
+  } // namespace detail
+
+
+  /**
+    @brief ThreadPool keeps a fixed set of worker threads for algorithms
+           which run many short parallel phases (e.g. one per BFS level),
+           so that threads are not created again for every phase.
+           run(fn) calls fn(t) for t = 0..size()-1, each on its own thread
+           (t = 0 on the calling thread), and returns when all are done.
+           If calls of fn throw, run() still waits for all threads and
+           then rethrows the first exception.
+  */
+  class ThreadPool
+  {
+  public:
+    /// Constructor; starts nthreads-1 workers
+    explicit ThreadPool(unsigned nthreads = detail::default_concurrency())
+    : m_size(nthreads > 0 ? nthreads : 1), m_generation(0), m_pending(0), m_stop(false)
+    {
+      for (unsigned t = 1; t < m_size; ++t) {
+        m_workers.emplace_back(&ThreadPool::work,this,t);
+      }
+    }
+
+    /// Destructor; stops the workers
+    ~ThreadPool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+      }
+      m_start.notify_all();
+      for (auto w = m_workers.begin(); w != m_workers.end(); ++w) {
+        w->join();
+      }
+    }
+
+    /// Number of threads (including the calling thread)
+    unsigned size() const { return m_size; }
+
+    /// Calls fn(t) on all threads and waits for them; rethrows the first
+    /// exception thrown by fn
+    template<typename FUNC>
+    void run(FUNC fn)
+    {
+      if (m_size == 1) {
+        fn(0u);
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = fn;
+        m_error = nullptr;
+        m_pending = m_size - 1;
+        ++m_generation;
+      }
+      m_start.notify_all();
+      try {
+        fn(0u);
+      }
+      catch (...) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_error) m_error = std::current_exception();
+      }
+      // The workers use fn and its captures, so wait for them in any case
+      std::exception_ptr error;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock,[this] { return m_pending == 0; });
+        m_task = nullptr;
+        std::swap(error,m_error);
+      }
+      if (error) std::rethrow_exception(error);
+    }
+
+  private:
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    /// Worker loop: wait for a new task, run it, report back (with the
+    /// exception it threw, if any)
+    void work(unsigned t)
+    {
+      unsigned seen = 0;
+      for (;;) {
+        std::function<void(unsigned)> task;
+        {
+          std::unique_lock<std::mutex> lock(m_mutex);
+          m_start.wait(lock,[&] { return m_stop || m_generation != seen; });
+          if (m_stop) return;
+          seen = m_generation;
+          task = m_task;
+        }
+        std::exception_ptr error;
+        try {
+          task(t);
+        }
+        catch (...) {
+          error = std::current_exception();
+        }
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          if (error && !m_error) m_error = error;
+          --m_pending;
+        }
+        m_done.notify_one();
+      }
+    }
+
+  private:
+    unsigned                          m_size;        ///< Number of threads
+    std::vector<std::thread>          m_workers;     ///< Threads 1..size()-1
+    std::mutex                        m_mutex;
+    std::condition_variable           m_start;       ///< Signals a new task
+    std::condition_variable           m_done;        ///< Signals a finished worker
+    std::function<void(unsigned)>     m_task;        ///< The current task
+    std::exception_ptr                m_error;       ///< First exception of the task
+    unsigned                          m_generation;  ///< Counts the tasks
+    unsigned                          m_pending;     ///< Workers still running
+    bool                              m_stop;        ///< Set by the destructor
+  }; // ThreadPool
+
+
+  namespace detail {
+
+    /**
+      @brief Appends the parts filled by the threads of pool to out:
+             part(t) is the vector of thread t. The parts are placed one
+             after the other at the prefix sums of their sizes, so every
+             thread copies its own part without synchronisation; then
+             done(t) is called on thread t (e.g. to clear the part).
+    */
+    template<typename VECTOR, typename PART, typename DONE>
+    void parallel_append(ThreadPool& pool, VECTOR& out, PART part, DONE done)
+    {
+      std::vector<std::size_t> offset(pool.size() + 1,out.size());
+      for (unsigned t = 0; t < pool.size(); ++t) {
+        offset[t+1] = offset[t] + part(t).size();
+      }
+      out.resize(offset.back());
+      pool.run([&](unsigned t) {
+        const auto& p = part(t);
+        std::copy(p.begin(),p.end(),out.begin() + offset[t]);
+        done(t);
+      });
+    }
+
+    /// Same as above without done()
+    template<typename VECTOR, typename PART>
+    void parallel_append(ThreadPool& pool, VECTOR& out, PART part)
+    {
+      parallel_append(pool,out,part,[](unsigned) {});
+    }
+
+  } // namespace detail
+
+} // namespace MyCoolGraphLibrary
+
+#endif
@@ -0,0 +1,205 @@
+////////////////////////////////////////////////////////////////////////////////
+// parallelbfs.hpp
+// Level-synchronous breadth-first search on several threads
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __PARALLELBFS_HPP__
+#define __PARALLELBFS_HPP__
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+#include "compressedgraph.hpp"
+#include "parallel.hpp"
+
+namespace MyCoolGraphLibrary {
+
+  namespace detail {
+    template<typename GRAPH> class ParallelBFS;
+  }
+
+  /**
+    @brief parallel_breadth_first_search() runs a level-synchronous BFS
+           from start on the threads of pool. The visitor is called on the
+           calling thread only, for all nodes of a level once the level is
+           complete, so it needs no synchronisation. Levels come in BFS
+           order; the order of the nodes within a level is unspecified.
+    @param g the graph (a dense graph like CompressedGraph)
+    @param start the start node
+    @param visitor called as visitor(node) for each reached node
+    @param pool the worker threads
+  */
+  template<typename GRAPH, typename VISITOR>
+  void parallel_breadth_first_search(const GRAPH& g,
+                                     const typename GRAPH::Node& start,
+                                     VISITOR& visitor, ThreadPool& pool)
+  {
+    detail::ParallelBFS<GRAPH> bfs_algorithm(g,pool);
+    bfs_algorithm.search(g.id(start),[&](typename GRAPH::NodeId id) {
+      visitor(g.node(id));
+    });
+  }
+
+  /// Same as above, with a temporary pool of nthreads threads
+  template<typename GRAPH, typename VISITOR>
+  void parallel_breadth_first_search(const GRAPH& g,
+                                     const typename GRAPH::Node& start,
+                                     VISITOR& visitor,
+                                     unsigned nthreads = detail::default_concurrency())
+  {
+    ThreadPool pool(nthreads);
+    parallel_breadth_first_search(g,start,visitor,pool);
+  }
+
+  /**
+    @brief parallel_bfs_levels() computes the BFS level of every node id
+           from start on the threads of pool (std::uint32_t(-1) for
+           unreachable nodes).
+  */
+  template<typename GRAPH>
+  std::vector<std::uint32_t> parallel_bfs_levels(const GRAPH& g,
+                                                 const typename GRAPH::Node& start,
+                                                 ThreadPool& pool)
+  {
+    std::vector<std::uint32_t> level(g.no_of_nodes(),std::uint32_t(-1));
+    detail::ParallelBFS<GRAPH> bfs_algorithm(g,pool);
+    std::uint32_t depth = 0;
+    bfs_algorithm.search(g.id(start),[&](typename GRAPH::NodeId) {},
+                         [&](const std::vector<typename GRAPH::NodeId>& frontier) {
+      for (auto v = frontier.begin(); v != frontier.end(); ++v) level[*v] = depth;
+      ++depth;
+    });
+    return level;
+  }
+
+  namespace detail {
+  /**
+    @brief Level-synchronous parallel BFS on dense node ids.
+           The frontier of each level is split into small blocks which the
+           threads take from a shared counter. A thread claims a target by
+           setting its bit in the visited bitmap with an atomic fetch_or;
+           only the thread which actually set the bit appends the node to
+           its own next-frontier buffer. After the level the buffers are
+           copied into the new frontier at offsets given by a prefix sum
+           over their sizes, again in parallel, so no lock is taken.
+  */
+  template<typename GRAPH>
+  class ParallelBFS
+  {
+  public:
+    typedef typename GRAPH::NodeId      NodeId;
+    typedef typename GRAPH::EdgeIndex   EdgeIndex;
+    typedef std::uint64_t               Word;
+
+  public:
+    /// Constructor
+    ParallelBFS(const GRAPH& g, ThreadPool& pool)
+    : graph(g), threads(pool), visited((g.no_of_nodes() + 63) / 64), local(pool.size())
+    {}
+
+    /**
+      @brief Runs the search from node id s (NoNode() does nothing).
+             visit(id) is called for each reached node, level by level,
+             on the calling thread.
+    */
+    template<typename VISIT>
+    void search(NodeId s, VISIT visit)
+    {
+      search(s,visit,[](const std::vector<NodeId>&) {});
+    }
+
+    /// Same as above; in addition, level_done(frontier) is called with the
+    /// nodes of each level after they have been visited
+    template<typename VISIT, typename LEVEL_DONE>
+    void search(NodeId s, VISIT visit, LEVEL_DONE level_done)
+    {
+      search_within(s,[](NodeId) { return true; },visit,level_done);
+    }
+
+    /// Same as above, but only follows edges to nodes v with allowed(v).
+    /// allowed() is called concurrently by all threads.
+    template<typename ALLOWED, typename VISIT, typename LEVEL_DONE>
+    void search_within(NodeId s, ALLOWED allowed, VISIT visit, LEVEL_DONE level_done)
+    {
+      clear();
+      if (s == GRAPH::NoNode()) return;
+
+      std::vector<NodeId> frontier(1,s), next;
+      claim(s);
+      while (!frontier.empty()) {
+        for (auto v = frontier.begin(); v != frontier.end(); ++v) visit(*v);
+        level_done(frontier);
+        expand(frontier,next,allowed);
+        frontier.swap(next);
+      }
+    }
+
+    /// Was node v reached by the last search?
+    bool reached(NodeId v) const
+    {
+      return (visited[v >> 6].load(std::memory_order_relaxed) >> (v & 63)) & 1;
+    }
+
+    /// Forgets the last search
+    void clear()
+    {
+      for (auto w = visited.begin(); w != visited.end(); ++w)
+        w->store(0,std::memory_order_relaxed);
+    }
+
+  private:
+    /// Sets the visited bit of v; true if this call set it
+    bool claim(NodeId v)
+    {
+      std::atomic<Word>& w = visited[v >> 6];
+      const Word bit = Word(1) << (v & 63);
+      // Cheap test first, most targets of a large frontier are visited
+      if (w.load(std::memory_order_relaxed) & bit) return false;
+      return (w.fetch_or(bit,std::memory_order_relaxed) & bit) == 0;
+    }
+
+    /// Computes the next frontier from frontier
+    template<typename ALLOWED>
+    void expand(const std::vector<NodeId>& frontier, std::vector<NodeId>& next,
+                ALLOWED& allowed)
+    {
+      const std::size_t block = 64;
+      std::atomic<std::size_t> position(0);
+
+      threads.run([&](unsigned t) {
+        std::vector<NodeId>& out = local[t];
+        out.clear();
+        for (;;) {
+          std::size_t b = position.fetch_add(block,std::memory_order_relaxed);
+          if (b >= frontier.size()) break;
+          std::size_t e = std::min(b + block,frontier.size());
+          for (std::size_t i = b; i < e; ++i) {
+            NodeId u = frontier[i];
+            for (EdgeIndex k = graph.first_edge(u); k != graph.last_edge(u); ++k) {
+              NodeId v = graph.target(k);
+              if (allowed(v) && claim(v)) out.push_back(v);
+            }
+          }
+        }
+      });
+
+      next.clear();
+      detail::parallel_append(threads,next,[&](unsigned t) -> const std::vector<NodeId>& {
+        return local[t];
+      });
+    }
+
+  private: // Member variables
+    const GRAPH& graph;
+    ThreadPool& threads;
+    std::vector< std::atomic<Word> > visited;       ///< One bit per node id
+    std::vector< std::vector<NodeId> > local;       ///< Next-frontier buffer per thread
+  }; // ParallelBFS
+
+  } // namespace detail
+} // namespace MyCoolGraphLibrary
+
+#endif
@@ -0,0 +1,285 @@
+////////////////////////////////////////////////////////////////////////////////
+// pointtopoint.hpp
+// Point-to-point shortest paths: bidirectional Dijkstra and A*
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __POINTTOPOINT_HPP__
+#define __POINTTOPOINT_HPP__
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cstddef>
+
+#include "compressedgraph.hpp"
+#include "reverse.hpp"
+#include "traversalworkspace.hpp"
+#include "dheap.hpp"
+
+namespace MyCoolGraphLibrary {
+
+  /**
+    @brief PointToPointPath holds the result of a single-pair search on a
+           dense graph: the distance and the node ids of a shortest path
+           from the source to the target.
+  */
+  template<typename GRAPH>
+  struct PointToPointPath
+  {
+    typedef typename GRAPH::NodeId    NodeId;
+    typedef typename distance_traits<typename GRAPH::Weight>::Distance Distance;
+
+    /// Distance if the target is not reachable
+    inline static Distance Infinity() { return std::numeric_limits<Distance>::max(); }
+
+    PointToPointPath() : distance(Infinity()), settled(0) {}
+
+    Distance            distance;   ///< Length of the path; Infinity() if there is none
+    std::vector<NodeId> path;       ///< Node ids from source to target (empty if none)
+    std::size_t         settled;    ///< Number of nodes settled by the search
+
+    /// Was a path found?
+    bool found() const { return !path.empty(); }
+  };
+
+  /**
+    @brief BidirectionalDijkstra answers single-pair queries on a dense
+           graph g, given its reverse g_rev with the same node ids (see
+           graph_reverse()). A forward search from the source on g and a
+           backward search from the target on g_rev take turns; the side
+           with the smaller queue minimum goes next. Whenever an edge
+           reaches a node already labelled by the other side, the sum of
+           both distances is a candidate path length mu. The search stops
+           as soon as the two queue minima add up to at least mu, since no
+           undiscovered path can be shorter then. So roughly the nodes in
+           two balls of half the distance get settled instead of all nodes
+           up to the full distance.
+           The state is kept in two TraversalWorkspaces, so repeated
+           queries on the same object allocate nothing.
+  */
+  template<typename GRAPH>
+  class BidirectionalDijkstra
+  {
+  public:
+    typedef typename GRAPH::NodeId                        NodeId;
+    typedef typename GRAPH::EdgeIndex                     EdgeIndex;
+    typedef typename distance_traits<typename GRAPH::Weight>::Distance Distance;
+    typedef PointToPointPath<GRAPH>                       Result;
+
+  public:
+    /// Constructor; g_rev must be the reverse of g
+    BidirectionalDijkstra(const GRAPH& g, const GRAPH& g_rev)
+    : side{ Side(g), Side(g_rev) }
+    {}
+
+    /// Shortest path from node id s to node id t
+    Result run(NodeId s, NodeId t)
+    {
+      Result result;
+      if (s == GRAPH::NoNode() || t == GRAPH::NoNode()) return result;
+      if (s == t) {
+        result.distance = Distance();
+        result.path.push_back(s);
+        return result;
+      }
+      side[0].start(s);
+      side[1].start(t);
+
+      Distance mu = Result::Infinity();
+      NodeId meet = GRAPH::NoNode();
+      // If one queue runs empty, all paths through its side are known
+      while (!side[0].heap.empty() && !side[1].heap.empty()) {
+        if (mu != Result::Infinity() && !(side[0].heap.top_key() + side[1].heap.top_key() < mu))
+          break;
+        unsigned d = (side[1].heap.top_key() < side[0].heap.top_key()) ? 1 : 0;
+        Side& self = side[d];
+        const Side& other = side[1-d];
+
+        NodeId u = self.heap.pop();
+        ++result.settled;
+        Distance du = self.workspace.distance(u);
+        self.workspace.set_color(u,Workspace::Black);
+        for (EdgeIndex e = self.graph.first_edge(u); e != self.graph.last_edge(u); ++e) {
+          NodeId v = self.graph.target(e);
+          Distance dv = du + Distance(self.graph.weight(e));
+          self.relax(u,v,dv);
+          if (other.workspace.visited(v)) {
+            Distance candidate = self.workspace.distance(v) + other.workspace.distance(v);
+            if (candidate < mu) {
+              mu = candidate;
+              meet = v;
+            }
+          }
+        }
+      }
+      if (meet == GRAPH::NoNode()) return result;
+
+      result.distance = mu;
+      // Forward predecessors lead back to s, backward ones on to t
+      for (NodeId v = meet; v != GRAPH::NoNode(); v = side[0].workspace.predecessor(v))
+        result.path.push_back(v);
+      std::reverse(result.path.begin(),result.path.end());
+      for (NodeId v = side[1].workspace.predecessor(meet); v != GRAPH::NoNode();
+           v = side[1].workspace.predecessor(v))
+        result.path.push_back(v);
+      return result;
+    }
+
+  private:
+    typedef TraversalWorkspace<GRAPH>             Workspace;
+    typedef detail::IndexedDaryHeap<Distance>     Heap;
+
+    /// State of one search direction
+    struct Side
+    {
+      Side(const GRAPH& g) : graph(g), workspace(g), heap(g.no_of_nodes()) {}
+
+      void start(NodeId s)
+      {
+        workspace.start();
+        heap.clear();
+        workspace.set_color(s,Workspace::Grey);
+        workspace.set_distance(s,Distance());
+        heap.push(s,Distance());
+      }
+
+      /// Offers distance dv to v via u
+      void relax(NodeId u, NodeId v, const Distance& dv)
+      {
+        if (!workspace.visited(v)) {
+          workspace.set_color(v,Workspace::Grey);
+          workspace.set_distance(v,dv);
+          workspace.set_predecessor(v,u);
+          heap.push(v,dv);
+        }
+        else if (workspace.color(v) == Workspace::Grey && dv < workspace.distance(v)) {
+          workspace.set_distance(v,dv);
+          workspace.set_predecessor(v,u);
+          heap.decrease_key(v,dv);
+        }
+      }
+
+      const GRAPH& graph;
+      Workspace workspace;
+      Heap heap;          ///< Needs top_key(), so not the workspace queue
+    };
+
+    Side side[2];         ///< Forward and backward search
+  }; // BidirectionalDijkstra
+
+  /**
+    @brief AStarSearch answers single-pair queries on a dense graph, guided
+           by a heuristic h(v) which estimates the distance from node id v
+           to the target. The queue is ordered by distance(v) + h(v) and the
+           search stops when the target leaves the queue. If h never
+           overestimates (is admissible), the path found is a shortest one;
+           a node whose distance improves after it was settled is put back
+           into the queue. With a consistent heuristic (h(u) <= w(u,v) + h(v))
+           that never happens and every node is settled at most once.
+           h = 0 gives Dijkstra's algorithm with early termination.
+  */
+  template<typename GRAPH>
+  class AStarSearch
+  {
+  public:
+    typedef typename GRAPH::NodeId                        NodeId;
+    typedef typename GRAPH::EdgeIndex                     EdgeIndex;
+    typedef typename distance_traits<typename GRAPH::Weight>::Distance Distance;
+    typedef PointToPointPath<GRAPH>                       Result;
+
+  public:
+    /// Constructor
+    explicit AStarSearch(const GRAPH& g)
+    : graph(g), workspace(g), heap(g.no_of_nodes())
+    {}
+
+    /// Shortest path from node id s to node id t with heuristic h
+    template<typename HEURISTIC>
+    Result run(NodeId s, NodeId t, HEURISTIC h)
+    {
+      Result result;
+      if (s == GRAPH::NoNode() || t == GRAPH::NoNode()) return result;
+      workspace.start();
+      heap.clear();
+      workspace.set_distance(s,Distance());
+      heap.push(s,Distance(h(s)));
+
+      while (!heap.empty()) {
+        NodeId u = heap.pop();
+        ++result.settled;
+        if (u == t) {
+          result.distance = workspace.distance(t);
+          for (NodeId v = t; v != GRAPH::NoNode(); v = workspace.predecessor(v))
+            result.path.push_back(v);
+          std::reverse(result.path.begin(),result.path.end());
+          return result;
+        }
+        Distance du = workspace.distance(u);
+        for (EdgeIndex e = graph.first_edge(u); e != graph.last_edge(u); ++e) {
+          NodeId v = graph.target(e);
+          Distance dv = du + Distance(graph.weight(e));
+          if (workspace.visited(v) && !(dv < workspace.distance(v))) continue;
+          workspace.set_distance(v,dv);
+          workspace.set_predecessor(v,u);
+          Distance key = dv + Distance(h(v));
+          if (heap.contains(v)) heap.decrease_key(v,key);
+          else heap.push(v,key);
+        }
+      }
+      return result;
+    }
+
+  private:
+    const GRAPH& graph;
+    TraversalWorkspace<GRAPH> workspace;
+    detail::IndexedDaryHeap<Distance> heap;   ///< Keys need not be monotone
+  }; // AStarSearch
+
+  /**
+    @brief shortest_path() finds a shortest path from start to target in a
+           dense graph with a bidirectional Dijkstra search
+    @param g the graph
+    @param g_rev the reverse of g (see graph_reverse())
+    @param start the source node
+    @param target the target node
+  */
+  template<typename GRAPH>
+  PointToPointPath<GRAPH> shortest_path(const GRAPH& g, const GRAPH& g_rev,
+                                        const typename GRAPH::Node& start,
+                                        const typename GRAPH::Node& target)
+  {
+    BidirectionalDijkstra<GRAPH> search(g,g_rev);
+    return search.run(g.id(start),g.id(target));
+  }
+
+  /// Same as above; builds the reverse graph first, which takes as long as
+  /// a full search. Keep a BidirectionalDijkstra object for many queries.
+  template<typename GRAPH>
+  PointToPointPath<GRAPH> shortest_path(const GRAPH& g,
+                                        const typename GRAPH::Node& start,
+                                        const typename GRAPH::Node& target)
+  {
+    GRAPH g_rev = graph_reverse(g);
+    return shortest_path(g,g_rev,start,target);
+  }
+
+  /**
+    @brief astar_shortest_path() finds a shortest path from start to target
+           in a dense graph with the A* algorithm
+    @param heuristic called as heuristic(v) for node ids v; must not
+           overestimate the distance from v to target
+  */
+  template<typename GRAPH, typename HEURISTIC>
+  PointToPointPath<GRAPH> astar_shortest_path(const GRAPH& g,
+                                              const typename GRAPH::Node& start,
+                                              const typename GRAPH::Node& target,
+                                              HEURISTIC heuristic)
+  {
+    AStarSearch<GRAPH> search(g);
+    return search.run(g.id(start),g.id(target),heuristic);
+  }
+
+} // namespace MyCoolGraphLibrary
+
+#endif
@@ -0,0 +1,297 @@
+////////////////////////////////////////////////////////////////////////////////
+// priorityqueues.hpp
+// Monotone priority queues for Dijkstra and compile-time queue policies
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __PRIORITYQUEUES_HPP__
+#define __PRIORITYQUEUES_HPP__
+
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <cstdint>
+
+#include "graphtraits.hpp"
+#include "dheap.hpp"
+
+namespace MyCoolGraphLibrary {
+
+  /*
+    All queues hold ids 0..n-1 with keys and share one interface:
+      Queue(n,max_edge_weight)
+      bool  empty() const
+      void  push(v,k)           v must not be in the queue
+      void  decrease_key(v,k)   v must be in the queue, k smaller than its key
+      Index pop()               removes an id with the smallest key
+      void  clear()
+    The bucket queues are monotone: a pushed key must not be smaller than
+    the last popped one, which holds for Dijkstra with non-negative weights.
+  */
+
+  namespace detail {
+
+    /// IndexedDaryHeap with the common queue constructor
+    template<typename KEY, unsigned D = 4>
+    class DaryHeapQueue : public IndexedDaryHeap<KEY,D>
+    {
+    public:
+      template<typename WEIGHT>
+      DaryHeapQueue(std::size_t n, const WEIGHT&) : IndexedDaryHeap<KEY,D>(n) {}
+    }; // DaryHeapQueue
+
+    /**
+      @brief Dial's bucket queue for integer keys. If all edge weights are
+             at most C, the keys in the queue always lie in [d,d+C] for
+             the last popped key d, so C+1 buckets used as a ring suffice.
+             decrease_key() adds a new entry; the old one is skipped when
+             its bucket is reached. All operations take O(1) time plus the
+             scan over empty buckets, which is small for small C.
+    */
+    template<typename KEY>
+    class DialQueue
+    {
+    public:
+      typedef KEY             Key;
+      typedef std::uint32_t   Index;
+
+      static_assert(std::is_integral<Key>::value,"Dial's queue needs integer keys");
+
+    public:
+      template<typename WEIGHT>
+      DialQueue(std::size_t n, const WEIGHT& max_edge_weight)
+      : buckets(std::size_t(max_edge_weight) + 1), key_of(n), queued(n,0),
+        live(0), current(0)
+      {}
+
+      bool empty() const { return live == 0; }
+
+      void push(Index v, const Key& k)
+      {
+        key_of[v] = k;
+        queued[v] = 1;
+        ++live;
+        bucket(k).push_back(v);
+      }
+
+      void decrease_key(Index v, const Key& k)
+      {
+        key_of[v] = k;
+        bucket(k).push_back(v);
+      }
+
+      Index pop()
+      {
+        for (;;) {
+          std::vector<Index>& b = bucket(current);
+          while (!b.empty()) {
+            Index v = b.back();
+            b.pop_back();
+            // Skip entries whose key was decreased or which were popped
+            if (queued[v] && key_of[v] == current) {
+              queued[v] = 0;
+              --live;
+              return v;
+            }
+          }
+          ++current;
+        }
+      }
+
+      void clear()
+      {
+        for (auto b = buckets.begin(); b != buckets.end(); ++b) {
+          for (auto v = b->begin(); v != b->end(); ++v) queued[*v] = 0;
+          b->clear();
+        }
+        live = 0;
+        current = 0;
+      }
+
+    private:
+      std::vector<Index>& bucket(const Key& k) { return buckets[std::size_t(k) % buckets.size()]; }
+
+    private:
+      std::vector< std::vector<Index> > buckets;  ///< Ring of buckets
+      std::vector<Key> key_of;                    ///< Current key of each id
+      std::vector<unsigned char> queued;          ///< Is the id in the queue?
+      std::size_t live;                           ///< Number of ids in the queue
+      Key current;                                ///< Key of the current bucket
+    }; // DialQueue
+
+    /**
+      @brief Radix heap (Ahuja, Mehlhorn, Orlin, Tarjan) for unsigned keys.
+             Bucket 0 holds keys equal to the last popped key "last", bucket
+             i > 0 the keys whose highest bit differing from last is bit
+             i-1. When bucket 0 is empty, the first non-empty bucket is
+             emptied into the lower ones after last has been set to its
+             minimum. Every entry moves down at most once per bit, so the
+             amortized cost is O(log C) per entry without comparisons of
+             whole heaps. decrease_key() works like in DialQueue.
+    */
+    template<typename KEY>
+    class RadixHeap
+    {
+    public:
+      typedef KEY             Key;
+      typedef std::uint32_t   Index;
+
+      static_assert(std::is_integral<Key>::value && std::is_unsigned<Key>::value,
+                    "the radix heap needs unsigned integer keys");
+
+    public:
+      template<typename WEIGHT>
+      RadixHeap(std::size_t n, const WEIGHT&)
+      : buckets(8 * sizeof(Key) + 1), key_of(n), queued(n,0), live(0), last(0)
+      {}
+
+      bool empty() const { return live == 0; }
+
+      void push(Index v, const Key& k)
+      {
+        key_of[v] = k;
+        queued[v] = 1;
+        ++live;
+        buckets[bucket_of(k)].push_back(Entry(k,v));
+      }
+
+      void decrease_key(Index v, const Key& k)
+      {
+        key_of[v] = k;
+        buckets[bucket_of(k)].push_back(Entry(k,v));
+      }
+
+      Index pop()
+      {
+        for (;;) {
+          // A bucket holding only stale entries leaves bucket 0 empty
+          while (buckets[0].empty()) refill();
+          Entry e = buckets[0].back();
+          buckets[0].pop_back();
+          if (is_current(e)) {
+            queued[e.second] = 0;
+            --live;
+            return e.second;
+          }
+        }
+      }
+
+      void clear()
+      {
+        for (auto b = buckets.begin(); b != buckets.end(); ++b) {
+          for (auto e = b->begin(); e != b->end(); ++e) queued[e->second] = 0;
+          b->clear();
+        }
+        live = 0;
+        last = 0;
+      }
+
+    private:
+      typedef std::pair<Key,Index> Entry;
+
+      bool is_current(const Entry& e) const
+      {
+        return queued[e.second] && key_of[e.second] == e.first;
+      }
+
+      std::size_t bucket_of(const Key& k) const
+      {
+        Key x = k ^ last;
+        std::size_t b = 0;
+        for (; x != 0; x >>= 1) ++b;
+        return b;
+      }
+
+      /// Moves the entries of the first non-empty bucket down
+      void refill()
+      {
+        std::size_t i = 1;
+        while (buckets[i].empty()) ++i;
+        // New last: the smallest current key in bucket i
+        bool found = false;
+        for (auto e = buckets[i].begin(); e != buckets[i].end(); ++e) {
+          if (is_current(*e) && (!found || e->first < last)) {
+            last = e->first;
+            found = true;
+          }
+        }
+        std::vector<Entry> moved;
+        moved.swap(buckets[i]);
+        for (auto e = moved.begin(); e != moved.end(); ++e) {
+          if (is_current(*e)) buckets[bucket_of(e->first)].push_back(*e);
+        }
+        moved.clear();
+        moved.swap(buckets[i]);   // keep the buffer
+      }
+
+    private:
+      std::vector< std::vector<Entry> > buckets;
+      std::vector<Key> key_of;                    ///< Current key of each id
+      std::vector<unsigned char> queued;          ///< Is the id in the queue?
+      std::size_t live;                           ///< Number of ids in the queue
+      Key last;                                   ///< Last popped key
+    }; // RadixHeap
+
+  } // namespace detail
+
+
+  /// Queue policy: indexed D-ary heap (any key type)
+  template<unsigned D = 4>
+  struct DaryHeapPolicy
+  {
+    template<typename KEY> struct queue { typedef detail::DaryHeapQueue<KEY,D> type; };
+  };
+
+  /// Queue policy: Dial's bucket queue (integer keys, small edge weights)
+  struct DialPolicy
+  {
+    template<typename KEY> struct queue { typedef detail::DialQueue<KEY> type; };
+  };
+
+  /// Queue policy: radix heap (unsigned integer keys)
+  struct RadixHeapPolicy
+  {
+    template<typename KEY> struct queue { typedef detail::RadixHeap<KEY> type; };
+  };
+
+  /**
+    @brief default_queue_policy<WEIGHT>::type is the queue used for edge
+           weights of type WEIGHT: Dial's queue for unsigned weights of at
+           most 16 bits (at most 65536 buckets), the radix heap for other
+           unsigned weights and a 4-ary heap otherwise (e.g. floating point
+           or signed weights).
+  */
+  template<typename WEIGHT>
+  struct default_queue_policy
+  {
+    typedef typename std::conditional<
+      std::is_integral<WEIGHT>::value && std::is_unsigned<WEIGHT>::value,
+      typename std::conditional<(sizeof(WEIGHT) <= 2),DialPolicy,RadixHeapPolicy>::type,
+      DaryHeapPolicy<4> >::type type;
+  };
+
+  /// is_queue_policy<T>::value is true for the policies above
+  template<typename T> struct is_queue_policy                    { static const bool value = false; };
+  template<unsigned D> struct is_queue_policy< DaryHeapPolicy<D> > { static const bool value = true; };
+  template<> struct is_queue_policy<DialPolicy>                  { static const bool value = true; };
+  template<> struct is_queue_policy<RadixHeapPolicy>             { static const bool value = true; };
+
+  namespace detail {
+    /// Largest edge weight of dense graph g (1 for unweighted graphs),
+    /// which bounds the key range of Dial's queue
+    template<typename GRAPH>
+    typename GRAPH::Weight max_edge_weight(const GRAPH& g)
+    {
+      typedef typename GRAPH::Weight Weight;
+      if (g.weight_array().empty()) return Weight(1);
+      Weight m = Weight();
+      for (auto w = g.weight_array().begin(); w != g.weight_array().end(); ++w) {
+        if (m < *w) m = *w;
+      }
+      return m;
+    }
+  } // namespace detail
+
+} // namespace MyCoolGraphLibrary
+
+#endif
@@ -8,37 +8,217 @@
 #ifndef __REVERSE_HPP__
 #define __REVERSE_HPP__
 
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <cstdint>
+
 #include "labeledgraph.hpp"
+#include "compressedgraph.hpp"
 #include "graphtransform.hpp"
+#include "parallel.hpp"
 
 namespace MyCoolGraphLibrary {
   
-  template<typename GRAPHEDGE>
+  /// Transformer adding the reverse of every edge, with its weight, to a
+  /// graph. Workers of the parallel graph_transform() collect their edges
+  /// in a graph of their own, which merge() appends.
+  template<typename GRAPHEDGE, typename STORAGE = FullEdgeStorage<GRAPHEDGE> >
   struct GraphReverser
   {
     typedef GRAPHEDGE Edge;
+    typedef LabeledDirectedGraph<GRAPHEDGE,STORAGE> Graph;
     
-    GraphReverser(LabeledDirectedGraph<GRAPHEDGE>& g) : graph(g) {}
+    GraphReverser(Graph& g) : graph(g) {}
     
     void prolog() {}
     void operator()(const typename GRAPHEDGE::Node& node){}
-    void operator()(const GRAPHEDGE& edge)
+    template<typename EDGE>
+    void operator()(const EDGE& edge)
     {
-      graph.add(Edge(edge.target(),edge.label(),edge.source()));
+      graph.add(detail::edge_maker<GRAPHEDGE>::make(edge.target(),edge.label(),edge.source(),
+                                                    edge_weight(edge)));
     }
     void epilog(){}
 
-    LabeledDirectedGraph<GRAPHEDGE>& graph;
+    /// Worker for the parallel graph_transform(); its graph uses the
+    /// default allocator, since the allocator of graph may not be
+    /// thread-safe
+    GraphReverser clone() const { return GraphReverser(std::make_shared<Graph>()); }
+
+    /// Moves the edges of worker w into graph
+    void merge(GraphReverser& w) { graph.append(std::move(w.graph)); }
+
+    Graph& graph;
+
+  private:
+    /// Constructor of a worker owning its graph
+    GraphReverser(const std::shared_ptr<Graph>& g) : graph(*g), own_graph(g) {}
+
+    std::shared_ptr<Graph> own_graph;   ///< The graph of a worker
   };
   
-  template<class GRAPHEDGE>
-  LabeledDirectedGraph<GRAPHEDGE> graph_reverse(const LabeledDirectedGraph<GRAPHEDGE>& g)
+  /// Reverse of g; it uses the allocator of g
+  template<class GRAPHEDGE, class STORAGE>
+  LabeledDirectedGraph<GRAPHEDGE,STORAGE> graph_reverse(const LabeledDirectedGraph<GRAPHEDGE,STORAGE>& g)
   {
-    LabeledDirectedGraph<GRAPHEDGE> g_rev = LabeledDirectedGraph<GRAPHEDGE>();
-    GraphReverser<GRAPHEDGE> reverser(g_rev);
+    LabeledDirectedGraph<GRAPHEDGE,STORAGE> g_rev(g.get_allocator());
+    GraphReverser<GRAPHEDGE,STORAGE> reverser(g_rev);
     graph_transform(g,reverser);
     return g_rev;
   }
+
+  /// Same as above on nthreads threads; the result is the same
+  template<class GRAPHEDGE, class STORAGE>
+  LabeledDirectedGraph<GRAPHEDGE,STORAGE> graph_reverse(const LabeledDirectedGraph<GRAPHEDGE,STORAGE>& g,
+                                                        unsigned nthreads)
+  {
+    LabeledDirectedGraph<GRAPHEDGE,STORAGE> g_rev(g.get_allocator());
+    GraphReverser<GRAPHEDGE,STORAGE> reverser(g_rev);
+    graph_transform(g,reverser,nthreads);
+    return g_rev;
+  }
+
+  /// Reverse of a CompressedGraph: same node ids, every edge u -> v becomes
+  /// v -> u with the same label and weight. Built with a counting sort by
+  /// target, so it takes linear time and doesn't go through add().
+  template<class GRAPHEDGE>
+  CompressedGraph<GRAPHEDGE> graph_reverse(const CompressedGraph<GRAPHEDGE>& g)
+  {
+    typedef CompressedGraph<GRAPHEDGE>  Graph;
+    typedef typename Graph::NodeId      NodeId;
+    typedef typename Graph::EdgeIndex   EdgeIndex;
+    typedef typename Graph::Label       Label;
+    typedef typename Graph::Weight      Weight;
+    const bool weighted = edge_traits<GRAPHEDGE>::has_weight;
+
+    // Count the in-degrees, then turn them into offsets
+    std::vector<EdgeIndex> offsets(g.no_of_nodes()+1,0);
+    for (EdgeIndex e = 0; e < g.no_of_edges(); ++e) {
+      ++offsets[g.target(e)+1];
+    }
+    for (NodeId v = 0; v < g.no_of_nodes(); ++v) {
+      offsets[v+1] += offsets[v];
+    }
+
+    // Place each edge at the next free position of its target
+    std::vector<EdgeIndex> next(offsets.begin(),offsets.end()-1);
+    std::vector<NodeId> targets(g.no_of_edges());
+    std::vector<Label>  labels(g.no_of_edges());
+    std::vector<Weight> weights(weighted ? g.no_of_edges() : 0);
+    for (NodeId u = 0; u < g.no_of_nodes(); ++u) {
+      for (EdgeIndex e = g.first_edge(u); e != g.last_edge(u); ++e) {
+        EdgeIndex pos = next[g.target(e)]++;
+        targets[pos] = u;
+        labels[pos] = g.label(e);
+        if (weighted)
+          weights[pos] = g.weight(e);
+      }
+    }
+    typename Graph::NodeVector nodes(g.nodes().begin(),g.nodes().end());
+    return Graph(std::move(nodes),std::move(offsets),std::move(targets),
+                 std::move(labels),std::move(weights));
+  }
+
+  /**
+    @brief Same as above on the threads of pool; the result is identical.
+           The source nodes are split into one chunk of about the same
+           number of edges per thread. Each thread counts the in-degrees
+           of the targets in its chunk, the counts are turned into a
+           separate start position per target and thread (prefix sums over
+           the threads, then over the targets), and each thread places its
+           edges at its own positions. Since the chunks follow the node
+           ids, the edges of a target stay sorted by source.
+           Needs one counter per node and thread.
+  */
+  template<class GRAPHEDGE>
+  CompressedGraph<GRAPHEDGE> graph_reverse(const CompressedGraph<GRAPHEDGE>& g, ThreadPool& pool)
+  {
+    typedef CompressedGraph<GRAPHEDGE>  Graph;
+    typedef typename Graph::NodeId      NodeId;
+    typedef typename Graph::EdgeIndex   EdgeIndex;
+    typedef typename Graph::Label       Label;
+    typedef typename Graph::Weight      Weight;
+    const bool weighted = edge_traits<GRAPHEDGE>::has_weight;
+    const NodeId n = g.no_of_nodes();
+    const EdgeIndex m = g.no_of_edges();
+    const unsigned nt = pool.size();
+    if (nt == 1) return graph_reverse(g);
+
+    // Source chunks with about m/nt edges, and plain target chunks
+    std::vector<NodeId> source_chunk(nt+1,n), target_chunk(nt+1,n);
+    for (unsigned t = 0; t < nt; ++t) {
+      auto first = g.offset_array().begin();
+      auto it = std::lower_bound(first,first + n,detail::chunk_begin(m,t,nt));
+      source_chunk[t] = NodeId(it - first);
+      target_chunk[t] = detail::chunk_begin(n,t,nt);
+    }
+
+    // count[t][v]: number of edges from chunk t to v, later the position
+    // of the next such edge in the reverse graph
+    std::vector< std::vector<EdgeIndex> > count(nt);
+    pool.run([&](unsigned t) {
+      count[t].assign(n,0);
+      for (EdgeIndex e = g.first_edge(source_chunk[t]); e < g.first_edge(source_chunk[t+1]); ++e)
+        ++count[t][g.target(e)];
+    });
+
+    std::vector<EdgeIndex> offsets(n+1,0);
+    std::vector<EdgeIndex> chunk_edges(nt+1,0);
+    pool.run([&](unsigned t) {
+      EdgeIndex total = 0;
+      for (NodeId v = target_chunk[t]; v < target_chunk[t+1]; ++v) {
+        EdgeIndex in_degree = 0;
+        for (unsigned c = 0; c < nt; ++c) {
+          EdgeIndex k = count[c][v];
+          count[c][v] = in_degree;
+          in_degree += k;
+        }
+        total += in_degree;
+        offsets[v+1] = total;
+      }
+      chunk_edges[t+1] = total;
+    });
+    for (unsigned t = 0; t < nt; ++t) chunk_edges[t+1] += chunk_edges[t];
+    // Final offsets, and the counts become absolute positions
+    pool.run([&](unsigned t) {
+      EdgeIndex start = chunk_edges[t];
+      for (NodeId v = target_chunk[t]; v < target_chunk[t+1]; ++v) {
+        for (unsigned c = 0; c < nt; ++c) count[c][v] += start;
+        start = (offsets[v+1] += chunk_edges[t]);
+      }
+    });
+
+    std::vector<NodeId> targets(m);
+    std::vector<Label>  labels(m);
+    std::vector<Weight> weights(weighted ? m : 0);
+    pool.run([&](unsigned t) {
+      std::vector<EdgeIndex>& next = count[t];
+      for (NodeId u = source_chunk[t]; u < source_chunk[t+1]; ++u) {
+        for (EdgeIndex e = g.first_edge(u); e != g.last_edge(u); ++e) {
+          NodeId v = g.target(e);
+          EdgeIndex pos = next[v]++;
+          targets[pos] = u;
+          labels[pos] = g.label(e);
+          if (weighted)
+            weights[pos] = g.weight(e);
+        }
+      }
+      std::vector<EdgeIndex>().swap(next);
+    });
+    typename Graph::NodeVector nodes(g.nodes().begin(),g.nodes().end());
+    return Graph(std::move(nodes),std::move(offsets),std::move(targets),
+                 std::move(labels),std::move(weights));
+  }
+
+  /// Same as above with a temporary pool of nthreads threads
+  template<class GRAPHEDGE>
+  CompressedGraph<GRAPHEDGE> graph_reverse(const CompressedGraph<GRAPHEDGE>& g, unsigned nthreads)
+  {
+    ThreadPool pool(nthreads);
+    return graph_reverse(g,pool);
+  }
 }
 
 #endif
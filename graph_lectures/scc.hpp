@@ -0,0 +1,497 @@
+////////////////////////////////////////////////////////////////////////////////
+// scc.hpp
+// Strongly connected components and the condensation of a dense graph
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __SCC_HPP__
+#define __SCC_HPP__
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+#include "graphedge.hpp"
+#include "compressedgraph.hpp"
+#include "reverse.hpp"
+#include "parallel.hpp"
+#include "parallelbfs.hpp"
+
+namespace MyCoolGraphLibrary {
+
+  /**
+    @brief Result of strongly_connected_components(). Components have dense
+           ids 0..no_of_components-1 in a topological order of the
+           condensation: every edge between two components leads from a
+           lower to a higher id.
+  */
+  struct StronglyConnectedComponents
+  {
+    typedef std::uint32_t                                 ComponentId;
+    /// Condensation edges; the label counts the graph edges they stand for
+    typedef SimpleGraphEdge<ComponentId,ComponentId>      CondensedEdge;
+    typedef CompressedGraph<CondensedEdge>                Condensation;
+
+    std::vector<ComponentId> component;        ///< Component of each node id
+    ComponentId              no_of_components;
+    Condensation             condensation;     ///< Nodes are the component ids
+  };
+
+  namespace detail {
+    template<typename GRAPH> class PearceSCC;
+    template<typename GRAPH> class ParallelSCC;
+
+    template<typename GRAPH>
+    StronglyConnectedComponents make_components(const GRAPH& g,
+                                                std::vector<std::uint32_t>&& component,
+                                                std::uint32_t no_of_components);
+  }
+
+  /**
+    @brief strongly_connected_components() computes the strongly connected
+           components of a dense graph with an iterative version of Pearce's
+           variant of Tarjan's algorithm (one DFS, linear time, no recursion).
+  */
+  template<typename GRAPH>
+  StronglyConnectedComponents strongly_connected_components(const GRAPH& g)
+  {
+    detail::PearceSCC<GRAPH> scc_algorithm(g);
+    std::uint32_t k = scc_algorithm.run();
+    return detail::make_components(g,scc_algorithm.take_components(),k);
+  }
+
+  /**
+    @brief parallel_strongly_connected_components() computes the same
+           components on nthreads threads with trimming, one forward-backward
+           search from a pivot (which finds the giant component of most real
+           graphs) and coloring for the rest. The component ids differ
+           from the sequential version, but are also topologically sorted.
+    @param g the graph
+    @param g_rev the reverse graph of g (see graph_reverse())
+  */
+  template<typename GRAPH>
+  StronglyConnectedComponents
+  parallel_strongly_connected_components(const GRAPH& g, const GRAPH& g_rev,
+                                         unsigned nthreads = detail::default_concurrency())
+  {
+    ThreadPool pool(nthreads);
+    detail::ParallelSCC<GRAPH> scc_algorithm(g,g_rev,pool);
+    std::uint32_t k = scc_algorithm.run();
+    return detail::make_components(g,scc_algorithm.take_components(),k);
+  }
+
+  /// Same as above, but builds the reverse graph itself
+  template<typename GRAPH>
+  StronglyConnectedComponents
+  parallel_strongly_connected_components(const GRAPH& g,
+                                         unsigned nthreads = detail::default_concurrency())
+  {
+    GRAPH g_rev = graph_reverse(g);
+    return parallel_strongly_connected_components(g,g_rev,nthreads);
+  }
+
+  namespace detail {
+
+    /// Builds the condensation edges (u,v,count) of component map comp,
+    /// sorted by source and target, as CSR arrays
+    template<typename GRAPH>
+    void condense(const GRAPH& g, const std::vector<std::uint32_t>& comp, std::uint32_t k,
+                  std::vector<std::uint64_t>& offsets, std::vector<std::uint32_t>& targets,
+                  std::vector<std::uint32_t>& counts)
+    {
+      typedef typename GRAPH::NodeId    NodeId;
+      typedef typename GRAPH::EdgeIndex EdgeIndex;
+      // Counting sort of the inter-component edges by source component
+      std::vector<std::uint64_t> start(k+1,0);
+      for (NodeId u = 0; u < g.no_of_nodes(); ++u) {
+        for (EdgeIndex e = g.first_edge(u); e != g.last_edge(u); ++e) {
+          if (comp[g.target(e)] != comp[u]) ++start[comp[u]+1];
+        }
+      }
+      for (std::uint32_t c = 0; c < k; ++c) start[c+1] += start[c];
+      std::vector<std::uint32_t> all(start[k]);
+      std::vector<std::uint64_t> pos(start.begin(),start.end()-1);
+      for (NodeId u = 0; u < g.no_of_nodes(); ++u) {
+        for (EdgeIndex e = g.first_edge(u); e != g.last_edge(u); ++e) {
+          std::uint32_t c = comp[g.target(e)];
+          if (c != comp[u]) all[pos[comp[u]]++] = c;
+        }
+      }
+      // Sort the targets of each component and merge duplicates
+      offsets.assign(1,0);
+      targets.clear();
+      counts.clear();
+      for (std::uint32_t c = 0; c < k; ++c) {
+        std::sort(all.begin() + start[c],all.begin() + start[c+1]);
+        for (std::uint64_t i = start[c]; i < start[c+1]; ++i) {
+          if (i > start[c] && all[i] == all[i-1]) {
+            ++counts.back();
+          }
+          else {
+            targets.push_back(all[i]);
+            counts.push_back(1);
+          }
+        }
+        offsets.push_back(targets.size());
+      }
+    }
+
+    /// Wraps a component map into the result and builds the condensation
+    template<typename GRAPH>
+    StronglyConnectedComponents make_components(const GRAPH& g,
+                                                std::vector<std::uint32_t>&& component,
+                                                std::uint32_t no_of_components)
+    {
+      typedef StronglyConnectedComponents::Condensation Condensation;
+      StronglyConnectedComponents result;
+      result.component = std::move(component);
+      result.no_of_components = no_of_components;
+
+      std::vector<std::uint64_t> offsets;
+      std::vector<std::uint32_t> targets, counts;
+      condense(g,result.component,no_of_components,offsets,targets,counts);
+      std::vector<std::uint32_t> nodes(no_of_components);
+      for (std::uint32_t c = 0; c < no_of_components; ++c) nodes[c] = c;
+      result.condensation = Condensation(std::move(nodes),std::move(offsets),std::move(targets),
+                                         std::move(counts),std::vector<Condensation::Weight>());
+      return result;
+    }
+
+  /**
+    @brief Pearce's algorithm ("A space-efficient algorithm for finding
+           strongly connected components", 2016) with an explicit stack.
+           Besides the call stack frames it needs one number per node
+           (rindex) and the stack of nodes whose component is still open.
+           A finished component gets the number c, counting down from n,
+           so finished nodes never lower the rindex of an open node.
+  */
+  template<typename GRAPH>
+  class PearceSCC
+  {
+  public:
+    typedef typename GRAPH::NodeId      NodeId;
+    typedef typename GRAPH::EdgeIndex   EdgeIndex;
+
+  public:
+    /// Constructor
+    PearceSCC(const GRAPH& g) : graph(g), rindex(g.no_of_nodes(),0) {}
+
+    /// Computes the components; returns their number
+    std::uint32_t run()
+    {
+      const NodeId n = graph.no_of_nodes();
+      index = 1;
+      c = n;    // one more than in the paper, so that 0 stays "unvisited"
+      for (NodeId s = 0; s < n; ++s) {
+        if (rindex[s] == 0) visit(s);
+      }
+      // Components were numbered from n down in reverse topological order
+      std::uint32_t k = n - c;
+      for (NodeId v = 0; v < n; ++v) rindex[v] = rindex[v] - c - 1;
+      return k;
+    }
+
+    /// Hands out the component of each node id (valid after run())
+    std::vector<std::uint32_t> take_components() { return std::move(rindex); }
+
+  private:
+    /// Iterative version of the recursive visit(v) of the paper
+    void visit(NodeId s)
+    {
+      begin(s);
+      while (!calls.empty()) {
+        Frame& f = calls.back();
+        NodeId v = f.node;
+        if (f.next != graph.last_edge(v)) {
+          NodeId w = graph.target(f.next++);
+          if (rindex[w] == 0) {
+            begin(w);
+          }
+          else if (rindex[w] < rindex[v]) {
+            rindex[v] = rindex[w];
+            f.root = false;
+          }
+          continue;
+        }
+        bool root = f.root;
+        calls.pop_back();
+        finish(v,root);
+        // Return to the caller: propagate the low value
+        if (!calls.empty()) {
+          Frame& p = calls.back();
+          if (rindex[v] < rindex[p.node]) {
+            rindex[p.node] = rindex[v];
+            p.root = false;
+          }
+        }
+      }
+    }
+
+    void begin(NodeId v)
+    {
+      rindex[v] = index++;
+      calls.push_back(Frame(v,graph.first_edge(v)));
+    }
+
+    /// v is done; if it is a root, pop its component
+    void finish(NodeId v, bool root)
+    {
+      if (!root) {
+        open.push_back(v);
+        return;
+      }
+      --index;
+      while (!open.empty() && rindex[v] <= rindex[open.back()]) {
+        rindex[open.back()] = c;
+        open.pop_back();
+        --index;
+      }
+      rindex[v] = c;
+      --c;
+    }
+
+  private: // Types
+    struct Frame
+    {
+      Frame(NodeId v, EdgeIndex e) : node(v), next(e), root(true) {}
+      NodeId    node;
+      EdgeIndex next;
+      bool      root;
+    };
+
+  private: // Member variables
+    const GRAPH& graph;
+    std::vector<std::uint32_t> rindex;  ///< Visit index, then component number
+    std::vector<Frame> calls;           ///< Explicit call stack
+    std::vector<NodeId> open;           ///< Nodes of unfinished components
+    std::uint32_t index;                ///< Next visit index
+    std::uint32_t c;                    ///< Next component number
+  }; // PearceSCC
+
+  /**
+    @brief Parallel SCC algorithm in three phases (see Slota et al.,
+           "BFS and Coloring-based Parallel Algorithms for Strongly
+           Connected Components"):
+           - trimming: nodes without in- or out-edges inside the remaining
+             graph are components of their own;
+           - forward-backward: the nodes reached from a pivot both forward
+             and backward form its component;
+           - coloring: every remaining node takes the largest node id which
+             reaches it; each node with its own id as color is the root of a
+             component, found by a backward search within its color.
+             Repeated until no node is left.
+           The components are numbered in the order they are found and
+           finally renumbered topologically.
+  */
+  template<typename GRAPH>
+  class ParallelSCC
+  {
+  public:
+    typedef typename GRAPH::NodeId      NodeId;
+    typedef typename GRAPH::EdgeIndex   EdgeIndex;
+    typedef std::uint32_t               ComponentId;
+
+    inline static ComponentId NoComponent() { return ComponentId(-1); }
+
+  public:
+    /// Constructor
+    ParallelSCC(const GRAPH& g, const GRAPH& g_rev, ThreadPool& pool)
+    : graph(g), rev_graph(g_rev), threads(pool), comp(g.no_of_nodes()),
+      color(g.no_of_nodes()), count(0)
+    {}
+
+    /// Computes the components; returns their number
+    std::uint32_t run()
+    {
+      for_all([&](NodeId v) { comp[v].store(NoComponent(),std::memory_order_relaxed); });
+      trim();
+      forward_backward();
+      while (trim(), coloring()) {}
+      renumber();
+      return count.load();
+    }
+
+    /// Hands out the component of each node id (valid after run())
+    std::vector<std::uint32_t> take_components() { return std::move(result); }
+
+  private:
+    /// Calls fn(v) for all node ids on all threads
+    template<typename FUNC>
+    void for_all(FUNC fn)
+    {
+      const NodeId n = graph.no_of_nodes();
+      const unsigned nt = threads.size();
+      threads.run([&](unsigned t) {
+        for (NodeId v = chunk_begin(n,t,nt); v < chunk_begin(n,t+1,nt); ++v)
+          fn(v);
+      });
+    }
+
+    bool assigned(NodeId v) const
+    {
+      return comp[v].load(std::memory_order_relaxed) != NoComponent();
+    }
+
+    /// Does v have an edge to another unassigned node in graph h?
+    bool has_open_edge(const GRAPH& h, NodeId v) const
+    {
+      for (EdgeIndex e = h.first_edge(v); e != h.last_edge(v); ++e) {
+        NodeId w = h.target(e);
+        if (w != v && !assigned(w)) return true;
+      }
+      return false;
+    }
+
+    /// Makes nodes without in- or out-edges into singleton components until
+    /// there are none left. The components of all assigned nodes are
+    /// complete, so such a node cannot lie on a cycle.
+    void trim()
+    {
+      std::atomic<bool> changed(true);
+      while (changed.load()) {
+        changed.store(false);
+        for_all([&](NodeId v) {
+          if (assigned(v)) return;
+          if (!has_open_edge(graph,v) || !has_open_edge(rev_graph,v)) {
+            comp[v].store(count.fetch_add(1),std::memory_order_relaxed);
+            changed.store(true,std::memory_order_relaxed);
+          }
+        });
+      }
+    }
+
+    /// Finds the component of the node with the largest degree product
+    void forward_backward()
+    {
+      NodeId pivot = GRAPH::NoNode();
+      std::uint64_t best = 0;
+      for (NodeId v = 0; v < graph.no_of_nodes(); ++v) {
+        std::uint64_t d = std::uint64_t(graph.out_degree(v)) * rev_graph.out_degree(v);
+        if (!assigned(v) && (pivot == GRAPH::NoNode() || d > best)) {
+          pivot = v;
+          best = d;
+        }
+      }
+      if (pivot == GRAPH::NoNode()) return;
+
+      auto open = [this](NodeId v) { return !assigned(v); };
+      auto nothing = [](NodeId) {};
+      auto level_done = [](const std::vector<NodeId>&) {};
+      ParallelBFS<GRAPH> forward(graph,threads), backward(rev_graph,threads);
+      forward.search_within(pivot,open,nothing,level_done);
+      backward.search_within(pivot,open,nothing,level_done);
+      ComponentId id = count.fetch_add(1);
+      for_all([&](NodeId v) {
+        if (forward.reached(v) && backward.reached(v))
+          comp[v].store(id,std::memory_order_relaxed);
+      });
+    }
+
+    /// One coloring round; returns false if no unassigned node is left
+    bool coloring()
+    {
+      std::atomic<bool> left(false);
+      for_all([&](NodeId v) {
+        if (!assigned(v)) {
+          color[v].store(v,std::memory_order_relaxed);
+          left.store(true,std::memory_order_relaxed);
+        }
+      });
+      if (!left.load()) return false;
+
+      // Propagate the largest color along the edges until nothing changes
+      std::atomic<bool> changed(true);
+      while (changed.load()) {
+        changed.store(false);
+        for_all([&](NodeId v) {
+          if (assigned(v)) return;
+          NodeId cv = color[v].load(std::memory_order_relaxed);
+          for (EdgeIndex e = graph.first_edge(v); e != graph.last_edge(v); ++e) {
+            NodeId w = graph.target(e);
+            if (assigned(w)) continue;
+            NodeId cw = color[w].load(std::memory_order_relaxed);
+            while (cw < cv && !color[w].compare_exchange_weak(cw,cv,std::memory_order_relaxed)) {}
+            if (cw < cv) changed.store(true,std::memory_order_relaxed);
+          }
+        });
+      }
+
+      // Roots keep their own id as color
+      std::vector<NodeId> roots;
+      for (NodeId v = 0; v < graph.no_of_nodes(); ++v) {
+        if (!assigned(v) && color[v].load(std::memory_order_relaxed) == v) roots.push_back(v);
+      }
+      // Backward search from each root within its color; the colors
+      // are disjoint, so the searches do not interfere
+      std::atomic<std::size_t> next_root(0);
+      threads.run([&](unsigned) {
+        std::vector<NodeId> queue;
+        for (std::size_t r; (r = next_root.fetch_add(1)) < roots.size(); ) {
+          NodeId root = roots[r];
+          ComponentId id = count.fetch_add(1);
+          queue.assign(1,root);
+          comp[root].store(id,std::memory_order_relaxed);
+          for (std::size_t head = 0; head < queue.size(); ++head) {
+            NodeId u = queue[head];
+            for (EdgeIndex e = rev_graph.first_edge(u); e != rev_graph.last_edge(u); ++e) {
+              NodeId w = rev_graph.target(e);
+              if (!assigned(w) && color[w].load(std::memory_order_relaxed) == root) {
+                comp[w].store(id,std::memory_order_relaxed);
+                queue.push_back(w);
+              }
+            }
+          }
+        }
+      });
+      return true;
+    }
+
+    /// Renumbers the components deterministically (by smallest node id)
+    /// and then topologically (Kahn's algorithm on the condensation)
+    void renumber()
+    {
+      const NodeId n = graph.no_of_nodes();
+      const ComponentId k = count.load();
+      std::vector<ComponentId> first(k,NoComponent());
+      result.resize(n);
+      ComponentId next = 0;
+      for (NodeId v = 0; v < n; ++v) {
+        ComponentId c = comp[v].load(std::memory_order_relaxed);
+        if (first[c] == NoComponent()) first[c] = next++;
+        result[v] = first[c];
+      }
+
+      std::vector<std::uint64_t> offsets;
+      std::vector<std::uint32_t> targets, counts;
+      condense(graph,result,k,offsets,targets,counts);
+      std::vector<std::uint32_t> in_degree(k,0), order;
+      for (auto t = targets.begin(); t != targets.end(); ++t) ++in_degree[*t];
+      for (ComponentId c = 0; c < k; ++c) {
+        if (in_degree[c] == 0) order.push_back(c);
+      }
+      for (std::size_t head = 0; head < order.size(); ++head) {
+        ComponentId c = order[head];
+        for (std::uint64_t i = offsets[c]; i < offsets[c+1]; ++i) {
+          if (--in_degree[targets[i]] == 0) order.push_back(targets[i]);
+        }
+      }
+      std::vector<ComponentId> position(k);
+      for (ComponentId i = 0; i < k; ++i) position[order[i]] = i;
+      for (NodeId v = 0; v < n; ++v) result[v] = position[result[v]];
+    }
+
+  private: // Member variables
+    const GRAPH& graph;
+    const GRAPH& rev_graph;
+    ThreadPool& threads;
+    std::vector< std::atomic<ComponentId> > comp;   ///< Component of each node id
+    std::vector< std::atomic<NodeId> > color;       ///< Color in the coloring phase
+    std::atomic<ComponentId> count;                 ///< Number of components
+    std::vector<ComponentId> result;                ///< Final component numbers
+  }; // ParallelSCC
+
+  } // namespace detail
+} // namespace MyCoolGraphLibrary
+
+#endif
@@ -0,0 +1,173 @@
+////////////////////////////////////////////////////////////////////////////////
+// sssp-check.cpp
+// Checks delta_stepping and distance_table against shortest_paths
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+// Usage: sssp-check [number of graphs per weight type] [random seed]
+// Build: g++ -std=c++17 -O2 -pthread sssp-check.cpp -o sssp-check
+//
+// On random weighted graphs (unsigned, 8 bit, 64 bit and floating point
+// weights, also all zero) and with several thread counts it compares
+// - delta_stepping() with several bucket widths, from a small fraction of
+//   the largest edge weight to above it,
+// - distance_table() for sources and targets with duplicates and a node
+//   which is not in the graph,
+// with the sequential shortest_paths(). It also checks that
+// delta_stepping() throws std::invalid_argument for a bucket width which
+// is zero, negative, NaN or too small for the edge weights.
+// Prints the number of failed checks and returns 1 if there were any.
+
+#include <vector>
+#include <random>
+#include <limits>
+#include <stdexcept>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include "wgraphedge.hpp"
+#include "labeledgraph.hpp"
+#include "compressedgraph.hpp"
+#include "dijkstra.hpp"
+#include "deltastepping.hpp"
+#include "distancetable.hpp"
+
+using MyCoolGraphLibrary::WeightedGraphEdge;
+using MyCoolGraphLibrary::LabeledDirectedGraph;
+using MyCoolGraphLibrary::CompressedGraph;
+using MyCoolGraphLibrary::ThreadPool;
+using MyCoolGraphLibrary::ShortestPathTree;
+using MyCoolGraphLibrary::distance_traits;
+
+static const unsigned thread_counts[] = { 1, 2, 3, 4, 8 };
+
+static unsigned failures = 0;
+
+/// Counts and reports a failed check
+void check(bool ok, const char* what, const char* weight, unsigned graph_no, unsigned nthreads = 0)
+{
+  if (ok) return;
+  ++failures;
+  std::cerr << "FAILED: " << what << " (" << weight << " weights, graph " << graph_no;
+  if (nthreads > 0) std::cerr << ", " << nthreads << " threads";
+  std::cerr << ")\n";
+}
+
+/// Random graph with up to n nodes, about n*degree edges and integral
+/// weights in [0,max_weight]
+template<typename WEIGHT>
+CompressedGraph< WeightedGraphEdge<unsigned,unsigned,WEIGHT> >
+random_graph(std::mt19937& rng, unsigned n, unsigned degree, unsigned max_weight)
+{
+  typedef WeightedGraphEdge<unsigned,unsigned,WEIGHT> Edge;
+  LabeledDirectedGraph<Edge> g;
+  g.add(Edge(0,0,n-1,WEIGHT(max_weight)));
+  for (unsigned i = 0; i < n * degree; ++i) {
+    g.add(Edge(rng() % n,0,rng() % n,WEIGHT(rng() % (max_weight + 1))));
+  }
+  return CompressedGraph<Edge>(g);
+}
+
+/// Runs all checks on graphs with weights of type WEIGHT in [0,max_weight].
+/// The weights are integers, so sums are exact also for floating point.
+template<typename WEIGHT>
+void check_weights(std::mt19937& rng, unsigned graphs, unsigned max_weight, const char* name)
+{
+  typedef CompressedGraph< WeightedGraphEdge<unsigned,unsigned,WEIGHT> > Graph;
+  typedef typename distance_traits<WEIGHT>::Distance Distance;
+  typedef ShortestPathTree<Graph> Tree;
+
+  for (unsigned i = 0; i < graphs; ++i) {
+    Graph g = random_graph<WEIGHT>(rng,2 + rng() % 3000,1 + i % 4,max_weight);
+    const unsigned n = g.no_of_nodes();
+
+    // delta_stepping() from a few start nodes
+    const Distance deltas[] = { Distance(max_weight / 100 + 1), Distance(max_weight / 4 + 1),
+                                Distance(3 * max_weight + 1) };
+    for (int s = 0; s < 2; ++s) {
+      unsigned start = g.node(rng() % n);
+      Tree tree = MyCoolGraphLibrary::shortest_paths(g,start);
+      for (unsigned nt : thread_counts) {
+        ThreadPool pool(nt);
+        for (Distance delta : deltas) {
+          check(MyCoolGraphLibrary::delta_stepping(g,start,delta,pool) == tree.distance,
+                "delta_stepping differs from shortest_paths",name,i,nt);
+        }
+      }
+    }
+
+    // distance_table() with duplicate and unknown nodes
+    const unsigned unknown = std::numeric_limits<unsigned>::max();
+    std::vector<unsigned> sources, targets;
+    for (unsigned k = 0; k < 20; ++k) sources.push_back(g.node(rng() % n));
+    for (unsigned k = 0; k < 1 + rng() % 30; ++k) targets.push_back(g.node(rng() % n));
+    sources.push_back(sources.front());
+    targets.push_back(targets.front());
+    sources.push_back(unknown);
+    targets.push_back(unknown);
+    std::vector<Distance> expected;
+    for (unsigned s : sources) {
+      Tree tree;
+      if (s != unknown) tree = MyCoolGraphLibrary::shortest_paths(g,s);
+      for (unsigned t : targets) {
+        expected.push_back((s == unknown || t == unknown) ? Tree::Infinity()
+                                                          : tree.distance[g.id(t)]);
+      }
+    }
+    for (unsigned nt : thread_counts) {
+      check(MyCoolGraphLibrary::distance_table(g,sources,targets,nt) == expected,
+            "distance_table differs from shortest_paths",name,i,nt);
+    }
+  }
+}
+
+/// Does delta_stepping(g,start,delta) throw std::invalid_argument?
+template<typename GRAPH, typename DISTANCE>
+bool rejects(const GRAPH& g, DISTANCE delta)
+{
+  try {
+    MyCoolGraphLibrary::delta_stepping(g,g.node(0),delta,2);
+  }
+  catch (const std::invalid_argument&) {
+    return true;
+  }
+  return false;
+}
+
+void check_invalid_delta()
+{
+  typedef WeightedGraphEdge<unsigned,unsigned,double> DoubleEdge;
+  typedef WeightedGraphEdge<unsigned,unsigned,std::uint64_t> LongEdge;
+  LabeledDirectedGraph<DoubleEdge> gd;
+  gd.add(DoubleEdge(0,0,1,1e9));
+  CompressedGraph<DoubleEdge> d(gd);
+  LabeledDirectedGraph<LongEdge> gl;
+  gl.add(LongEdge(0,0,1,std::uint64_t(1) << 40));
+  CompressedGraph<LongEdge> l(gl);
+
+  check(rejects(d,0.0),"delta 0 is accepted","double",0);
+  check(rejects(d,-1.0),"negative delta is accepted","double",0);
+  check(rejects(d,std::numeric_limits<double>::quiet_NaN()),"NaN delta is accepted","double",0);
+  check(rejects(d,1e-3),"too small delta is accepted","double",0);
+  check(!rejects(d,1e6),"delta 1e6 is rejected","double",0);
+  check(rejects(l,std::uint64_t(0)),"delta 0 is accepted","64 bit",0);
+  check(rejects(l,std::uint64_t(1)),"too small delta is accepted","64 bit",0);
+  check(!rejects(l,std::uint64_t(1) << 30),"delta 2^30 is rejected","64 bit",0);
+}
+
+int main(int argc, char* argv[])
+{
+  const unsigned graphs = (argc > 1) ? std::atoi(argv[1]) : 12;
+  const unsigned seed = (argc > 2) ? std::atoi(argv[2]) : 42;
+
+  std::mt19937 rng(seed);
+  check_weights<unsigned>(rng,graphs,100,"unsigned");
+  check_weights<unsigned>(rng,graphs,0,"zero");
+  check_weights<std::uint8_t>(rng,graphs,3,"8 bit");
+  check_weights<std::uint64_t>(rng,graphs,1000000,"64 bit");
+  check_weights<double>(rng,graphs,50,"double");
+  check_invalid_delta();
+  std::cout << 5 * graphs << " graphs, " << failures << " failed checks\n";
+  return failures ? 1 : 0;
+}
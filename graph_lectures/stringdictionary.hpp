@@ -0,0 +1,233 @@
+////////////////////////////////////////////////////////////////////////////////
+// stringdictionary.hpp
+// Interning of node and label strings as small integer handles
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __STRINGDICTIONARY_HPP__
+#define __STRINGDICTIONARY_HPP__
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+
+#include "arrayref.hpp"
+
+namespace MyCoolGraphLibrary {
+
+/**
+  @brief StringDictionary stores each distinct string exactly once and
+         maps it to a handle. Handles are numbered 0,1,2,... in the order
+         in which the strings were interned and never change.
+         All strings live '\0'-terminated in one character arena, the
+         lookup table is an open-addressing hash table of handles, so
+         interning a known string does not allocate.
+         A graph over handles, e.g.
+         LabeledDirectedGraph<WeightedGraphEdge<Handle,Handle>>,
+         compares nodes as integers and converts them back to text only
+         for output.
+         Like CompressedGraph, the dictionary can also refer to external
+         memory (a mapped graph file). It is copied into owned memory when
+         a new string is interned.
+*/
+class StringDictionary
+{
+public: // Types
+  typedef std::uint32_t     Handle;
+  typedef std::uint64_t     Offset;
+
+public: // Static functions
+  inline static Handle NoHandle() { return Handle(-1); }
+
+public:
+  /// Constructor
+  StringDictionary() : m_offset_data(1,0), m_table_data(16,NoHandle()) { attach(); }
+
+  /// Constructs a dictionary from arrays in external memory, which owner
+  /// keeps alive. The arrays have the layout of arena(), offsets(),
+  /// hashes() and table().
+  StringDictionary(detail::ArrayRef<char> arena, detail::ArrayRef<Offset> offsets,
+                   detail::ArrayRef<std::uint32_t> hashes, detail::ArrayRef<Handle> table,
+                   std::shared_ptr<const void> owner)
+  : m_arena(arena), m_offsets(offsets), m_hashes(hashes), m_table(table), m_owner(owner)
+  {}
+
+  /// Copy constructor
+  StringDictionary(const StringDictionary& d)
+  : m_arena_data(d.m_arena_data), m_offset_data(d.m_offset_data),
+    m_hash_data(d.m_hash_data), m_table_data(d.m_table_data),
+    m_arena(d.m_arena), m_offsets(d.m_offsets), m_hashes(d.m_hashes),
+    m_table(d.m_table), m_owner(d.m_owner)
+  {
+    if (!m_owner) attach();
+  }
+
+  /// Move constructor
+  StringDictionary(StringDictionary&& d) : StringDictionary() { swap(d); }
+
+  /// Assignment
+  StringDictionary& operator=(StringDictionary d)
+  {
+    swap(d);
+    return *this;
+  }
+
+  /// Exchanges the contents of two dictionaries
+  void swap(StringDictionary& d)
+  {
+    m_arena_data.swap(d.m_arena_data);
+    m_offset_data.swap(d.m_offset_data);
+    m_hash_data.swap(d.m_hash_data);
+    m_table_data.swap(d.m_table_data);
+    std::swap(m_arena,d.m_arena);
+    std::swap(m_offsets,d.m_offsets);
+    std::swap(m_hashes,d.m_hashes);
+    std::swap(m_table,d.m_table);
+    m_owner.swap(d.m_owner);
+  }
+
+  /// Returns the handle of s, adding s to the dictionary if necessary
+  Handle intern(std::string_view s)
+  {
+    std::uint32_t h = hash(s);
+    std::size_t slot = find_slot(s,h);
+    if (m_table[slot] != NoHandle())
+      return m_table[slot];
+
+    // New string: append it to the arena
+    if (m_owner) copy_to_owned();
+    Handle handle = size();
+    m_arena_data.insert(m_arena_data.end(),s.begin(),s.end());
+    m_arena_data.push_back('\0');
+    m_offset_data.push_back(m_arena_data.size());
+    m_hash_data.push_back(h);
+    m_table_data[slot] = handle;
+    // Keep the load factor below 1/2
+    if (2 * m_hash_data.size() > m_table_data.size())
+      rehash(2 * m_table_data.size());
+    attach();
+    return handle;
+  }
+
+  /// Returns the handle of s or NoHandle() if s has not been interned
+  Handle find(std::string_view s) const
+  {
+    return m_table[find_slot(s,hash(s))];
+  }
+
+  /// Returns the string for handle h
+  std::string_view str(Handle h) const
+  {
+    return std::string_view(&m_arena[m_offsets[h]],m_offsets[h+1] - m_offsets[h] - 1);
+  }
+
+  /// Returns the '\0'-terminated string for handle h
+  const char* c_str(Handle h) const { return &m_arena[m_offsets[h]]; }
+
+  /// Name of a handle for output functions (see GraphDotOutputter)
+  std::string_view name(Handle h) const { return str(h); }
+
+  /// Returns the number of distinct strings
+  Handle size() const { return m_hashes.size(); }
+
+  /// Reserve memory for n strings with a total of chars characters
+  void reserve(std::size_t n, std::size_t chars)
+  {
+    if (m_owner) copy_to_owned();
+    m_arena_data.reserve(chars + n);
+    m_offset_data.reserve(n + 1);
+    m_hash_data.reserve(n);
+    std::size_t tsize = m_table_data.size();
+    while (2 * n > tsize) tsize *= 2;
+    if (tsize > m_table_data.size())
+      rehash(tsize);
+    attach();
+  }
+
+  /// Number of bytes used by the string data
+  std::size_t arena_size() const { return m_arena.size(); }
+
+  /// Raw arrays, e.g. for writing the dictionary to a file
+  const detail::ArrayRef<char>&          arena()   const { return m_arena; }
+  const detail::ArrayRef<Offset>&        offsets() const { return m_offsets; }
+  const detail::ArrayRef<std::uint32_t>& hashes()  const { return m_hashes; }
+  const detail::ArrayRef<Handle>&        table()   const { return m_table; }
+
+private: // Functions
+  /// FNV-1a hash
+  static std::uint32_t hash(std::string_view s)
+  {
+    std::uint32_t h = 2166136261u;
+    for (auto c = s.begin(); c != s.end(); ++c) {
+      h ^= static_cast<unsigned char>(*c);
+      h *= 16777619u;
+    }
+    return h;
+  }
+
+  /// Returns the slot of s in the table: either the slot holding its
+  /// handle or the empty slot where it would be inserted
+  std::size_t find_slot(std::string_view s, std::uint32_t h) const
+  {
+    std::size_t mask = m_table.size() - 1;
+    for (std::size_t slot = h & mask; ; slot = (slot + 1) & mask) {
+      Handle c = m_table[slot];
+      if (c == NoHandle() || (m_hashes[c] == h && str(c) == s))
+        return slot;
+    }
+  }
+
+  /// Rebuild the hash table with tsize slots (a power of 2)
+  void rehash(std::size_t tsize)
+  {
+    m_table_data.assign(tsize,NoHandle());
+    std::size_t mask = tsize - 1;
+    for (Handle c = 0; c < m_hash_data.size(); ++c) {
+      std::size_t slot = m_hash_data[c] & mask;
+      while (m_table_data[slot] != NoHandle())
+        slot = (slot + 1) & mask;
+      m_table_data[slot] = c;
+    }
+  }
+
+  /// Copies external arrays into owned memory before a modification
+  void copy_to_owned()
+  {
+    m_arena_data.assign(m_arena.begin(),m_arena.end());
+    m_offset_data.assign(m_offsets.begin(),m_offsets.end());
+    m_hash_data.assign(m_hashes.begin(),m_hashes.end());
+    m_table_data.assign(m_table.begin(),m_table.end());
+    m_owner.reset();
+    attach();
+  }
+
+  /// Points the views to the owned arrays
+  void attach()
+  {
+    m_arena   = detail::ArrayRef<char>(m_arena_data);
+    m_offsets = detail::ArrayRef<Offset>(m_offset_data);
+    m_hashes  = detail::ArrayRef<std::uint32_t>(m_hash_data);
+    m_table   = detail::ArrayRef<Handle>(m_table_data);
+  }
+
+private:
+  // Owned arrays (empty if the dictionary lives in external memory)
+  std::vector<char>           m_arena_data;
+  std::vector<Offset>         m_offset_data;
+  std::vector<std::uint32_t>  m_hash_data;
+  std::vector<Handle>         m_table_data;
+
+  // Views used by all accessors
+  detail::ArrayRef<char>          m_arena;   ///< All strings, '\0'-terminated
+  detail::ArrayRef<Offset>        m_offsets; ///< String h starts at m_arena[m_offsets[h]]
+  detail::ArrayRef<std::uint32_t> m_hashes;  ///< Hash value of each string
+  detail::ArrayRef<Handle>        m_table;   ///< Open-addressing hash table
+  std::shared_ptr<const void>     m_owner;   ///< Keeps external memory alive
+}; // StringDictionary
+
+} // namespace MyCoolGraphLibrary
+
+#endif
@@ -0,0 +1,274 @@
+////////////////////////////////////////////////////////////////////////////////
+// topologicalsort.hpp
+// Topological sorting and cycle detection for dense graphs
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __TOPOLOGICALSORT_HPP__
+#define __TOPOLOGICALSORT_HPP__
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+#include "compressedgraph.hpp"
+#include "dfs.hpp"
+#include "parallel.hpp"
+
+namespace MyCoolGraphLibrary {
+
+  namespace detail {
+
+    /// Collects the finish order and stops at the first back edge
+    template<typename GRAPH>
+    struct TopologicalSortVisitor : public DFSVisitor<GRAPH>
+    {
+      typedef typename GRAPH::NodeId      NodeId;
+      typedef typename GRAPH::EdgeIndex   EdgeIndex;
+
+      TopologicalSortVisitor(std::vector<NodeId>& o) : order(o), cyclic(false) {}
+
+      void finish_node(NodeId u)             { order.push_back(u); }
+      void back_edge(NodeId, EdgeIndex)      { cyclic = true; }
+      bool stop() const                      { return cyclic; }
+
+      std::vector<NodeId>& order;
+      bool cyclic;
+    };
+
+    /// Records the DFS tree and stops at the first back edge
+    template<typename GRAPH>
+    struct CycleFinder : public DFSVisitor<GRAPH>
+    {
+      typedef typename GRAPH::NodeId      NodeId;
+      typedef typename GRAPH::EdgeIndex   EdgeIndex;
+
+      CycleFinder(const GRAPH& g)
+      : graph(g), parent(g.no_of_nodes()), from(GRAPH::NoNode()), to(GRAPH::NoNode()) {}
+
+      void tree_edge(NodeId u, EdgeIndex e)  { parent[graph.target(e)] = u; }
+      void back_edge(NodeId u, EdgeIndex e)  { from = u; to = graph.target(e); }
+      bool stop() const                      { return to != GRAPH::NoNode(); }
+
+      const GRAPH& graph;
+      std::vector<NodeId> parent;   ///< Parent in the DFS tree
+      NodeId from, to;              ///< The back edge closing the cycle
+    };
+
+    template<typename GRAPH> class ParallelKahn;
+
+  } // namespace detail
+
+  /**
+    @brief Result of topological_levels() for a dense graph. Level 0 holds
+           the nodes without in-edges, level i+1 the nodes all of whose
+           predecessors are in levels 0..i; so the nodes of one level do
+           not depend on each other and can be processed at the same time.
+  */
+  template<typename GRAPH>
+  struct TopologicalLevels
+  {
+    typedef typename GRAPH::NodeId      NodeId;
+    typedef std::uint32_t               Level;
+
+    inline static Level NoLevel() { return Level(-1); }
+
+    /// Node ids level by level (sorted within a level)
+    std::vector<NodeId> order;
+    /// Start of each level in order, plus the end
+    std::vector<std::size_t> level_begin;
+    /// Level of each node id; NoLevel() for nodes on or behind a cycle
+    std::vector<Level> level;
+    /// The node ids of a cycle in edge order; empty for a DAG
+    std::vector<NodeId> cycle;
+
+    bool acyclic() const { return cycle.empty(); }
+    Level no_of_levels() const { return Level(level_begin.size() - 1); }
+  };
+
+  /**
+    @brief topological_levels() runs Kahn's algorithm on nthreads threads:
+           the in-degrees are counted in parallel, then each level (the
+           nodes whose in-degree dropped to zero) is peeled in parallel.
+           If the graph has a cycle, the nodes on or behind cycles get no
+           level and one cycle is reported (found by the iterative DFS).
+  */
+  template<typename GRAPH>
+  TopologicalLevels<GRAPH> topological_levels(const GRAPH& g,
+                                              unsigned nthreads = detail::default_concurrency())
+  {
+    ThreadPool pool(nthreads);
+    detail::ParallelKahn<GRAPH> kahn_algorithm(g,pool);
+    TopologicalLevels<GRAPH> result;
+    kahn_algorithm.run(result);
+    return result;
+  }
+
+  /**
+    @brief topological_sort() orders the nodes of a dense graph so that every
+           edge leads from an earlier to a later node. It runs a single
+           iterative DFS and stops at the first back edge.
+    @param g the graph
+    @param order receives the nodes in topological order
+    @return false (and an empty order) if g has a cycle
+  */
+  template<typename GRAPH>
+  bool topological_sort(const GRAPH& g, std::vector<typename GRAPH::Node>& order)
+  {
+    std::vector<typename GRAPH::NodeId> finished;
+    finished.reserve(g.no_of_nodes());
+    detail::TopologicalSortVisitor<GRAPH> visitor(finished);
+    order.clear();
+    if (!depth_first_visit(g,visitor)) return false;
+    order.reserve(finished.size());
+    for (auto u = finished.rbegin(); u != finished.rend(); ++u) {
+      order.push_back(g.node(*u));
+    }
+    return true;
+  }
+
+  /**
+    @brief find_cycle() looks for a directed cycle in a dense graph
+    @param g the graph
+    @param cycle receives the nodes of a cycle in edge order (the last node
+           has an edge to the first one); empty if there is none
+    @return true if g has a cycle
+  */
+  template<typename GRAPH>
+  bool find_cycle(const GRAPH& g, std::vector<typename GRAPH::Node>& cycle)
+  {
+    detail::CycleFinder<GRAPH> visitor(g);
+    cycle.clear();
+    if (depth_first_visit(g,visitor)) return false;
+    // Walk up the DFS tree from the source of the back edge to its target
+    for (typename GRAPH::NodeId u = visitor.from; u != visitor.to; u = visitor.parent[u]) {
+      cycle.push_back(g.node(u));
+    }
+    cycle.push_back(g.node(visitor.to));
+    std::reverse(cycle.begin(),cycle.end());
+    return true;
+  }
+
+  namespace detail {
+  /**
+    @brief Level-synchronous Kahn's algorithm. The in-degrees are atomic
+           counters; a thread which decrements a counter to zero owns that
+           node and appends it to its own buffer. The buffers are joined at
+           prefix-sum offsets, like the frontiers in ParallelBFS.
+  */
+  template<typename GRAPH>
+  class ParallelKahn
+  {
+  public:
+    typedef typename GRAPH::NodeId      NodeId;
+    typedef typename GRAPH::EdgeIndex   EdgeIndex;
+    typedef TopologicalLevels<GRAPH>    Result;
+
+  public:
+    /// Constructor
+    ParallelKahn(const GRAPH& g, ThreadPool& pool)
+    : graph(g), threads(pool), in_degree(g.no_of_nodes()), local(pool.size())
+    {}
+
+    /// Computes the levels into result
+    void run(Result& result)
+    {
+      const NodeId n = graph.no_of_nodes();
+      const unsigned nt = threads.size();
+      result.order.clear();
+      result.order.reserve(n);
+      result.level.assign(n,Result::NoLevel());
+      result.level_begin.assign(1,0);
+      result.cycle.clear();
+
+      // Count the in-degrees; each thread takes a range of sources
+      threads.run([&](unsigned t) {
+        for (NodeId v = chunk_begin(n,t,nt); v < chunk_begin(n,t+1,nt); ++v)
+          in_degree[v].store(0,std::memory_order_relaxed);
+      });
+      threads.run([&](unsigned t) {
+        for (NodeId u = chunk_begin(n,t,nt); u < chunk_begin(n,t+1,nt); ++u) {
+          for (EdgeIndex e = graph.first_edge(u); e != graph.last_edge(u); ++e)
+            in_degree[graph.target(e)].fetch_add(1,std::memory_order_relaxed);
+        }
+      });
+      threads.run([&](unsigned t) {
+        local[t].clear();
+        for (NodeId v = chunk_begin(n,t,nt); v < chunk_begin(n,t+1,nt); ++v) {
+          if (in_degree[v].load(std::memory_order_relaxed) == 0) local[t].push_back(v);
+        }
+      });
+      append_level(result);
+
+      // Peel one level after the other
+      while (result.level_begin.back() > result.level_begin[result.level_begin.size()-2]) {
+        const std::size_t b = result.level_begin[result.level_begin.size()-2];
+        const std::size_t e = result.level_begin.back();
+        const std::size_t block = 64;
+        std::atomic<std::size_t> position(b);
+        threads.run([&](unsigned t) {
+          std::vector<NodeId>& out = local[t];
+          out.clear();
+          for (;;) {
+            std::size_t first = position.fetch_add(block,std::memory_order_relaxed);
+            if (first >= e) break;
+            std::size_t last = std::min(first + block,e);
+            for (std::size_t i = first; i < last; ++i) {
+              NodeId u = result.order[i];
+              for (EdgeIndex k = graph.first_edge(u); k != graph.last_edge(u); ++k) {
+                NodeId v = graph.target(k);
+                if (in_degree[v].fetch_sub(1,std::memory_order_acq_rel) == 1) out.push_back(v);
+              }
+            }
+          }
+        });
+        append_level(result);
+      }
+      result.level_begin.pop_back();   // the last level is empty
+
+      if (result.order.size() < n) {
+        std::vector<typename GRAPH::Node> cycle;
+        find_cycle(graph,cycle);
+        for (auto v = cycle.begin(); v != cycle.end(); ++v) result.cycle.push_back(graph.id(*v));
+      }
+    }
+
+  private:
+    /// Appends the per-thread buffers as a new level
+    void append_level(Result& result)
+    {
+      const std::size_t b = result.order.size();
+      const typename Result::Level depth = typename Result::Level(result.level_begin.size() - 1);
+      detail::parallel_append(threads,result.order,
+        [&](unsigned t) -> const std::vector<NodeId>& { return local[t]; },
+        [&](unsigned t) {
+          for (auto v = local[t].begin(); v != local[t].end(); ++v) result.level[*v] = depth;
+        });
+      // Which thread found a node is a matter of timing; sorting makes
+      // the order reproducible
+      std::sort(result.order.begin() + b,result.order.end());
+      result.level_begin.push_back(result.order.size());
+    }
+
+  private: // Member variables
+    const GRAPH& graph;
+    ThreadPool& threads;
+    std::vector< std::atomic<std::uint32_t> > in_degree;  ///< Remaining in-degree of each node
+    std::vector< std::vector<NodeId> > local;             ///< New level nodes per thread
+  }; // ParallelKahn
+
+  } // namespace detail
+
+  /// Returns true if the dense graph g has a directed cycle
+  template<typename GRAPH>
+  bool has_cycle(const GRAPH& g)
+  {
+    std::vector<typename GRAPH::NodeId> finished;
+    detail::TopologicalSortVisitor<GRAPH> visitor(finished);
+    return !depth_first_visit(g,visitor);
+  }
+
+} // namespace MyCoolGraphLibrary
+
+#endif
@@ -0,0 +1,161 @@
+////////////////////////////////////////////////////////////////////////////////
+// traversalworkspace.hpp
+// Reusable per-node state for repeated searches on a dense graph
+// 17.10.26
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __TRAVERSALWORKSPACE_HPP__
+#define __TRAVERSALWORKSPACE_HPP__
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <optional>
+#include <cstdint>
+
+#include "graphtraits.hpp"
+#include "priorityqueues.hpp"
+
+namespace MyCoolGraphLibrary {
+
+  /**
+    @brief TraversalWorkspace holds the per-node state of a search (visited
+           flag, color, distance and predecessor, each in an array indexed
+           by node id) together with the queue, stack and heap buffers; the
+           heap is the default queue for the weight type of GRAPH (see
+           default_queue_policy) and is only built by the first heap() call,
+           so searches without a queue do not pay for it. It is created
+           once for a graph and passed to breadth_first_search(),
+           depth_first_search() or distance_search() for every query.
+           The state is not cleared between searches: each node carries the
+           number (epoch) of the search which last touched it, and state
+           with an old epoch counts as "white, not visited". So starting a
+           search takes O(1) time and allocates nothing once the buffers
+           have grown.
+           A workspace must only be used by one search at a time.
+  */
+  template<typename GRAPH>
+  class TraversalWorkspace
+  {
+  public: // Types
+    typedef typename GRAPH::NodeId                NodeId;
+    typedef typename GRAPH::EdgeIndex             EdgeIndex;
+    typedef typename GRAPH::Weight                Weight;
+    typedef typename distance_traits<Weight>::Distance Distance;
+    typedef std::uint32_t                         Epoch;
+    typedef unsigned char                         Color;
+    /// DFS stack frame: a grey node and the index of its next out-edge
+    typedef std::pair<NodeId,EdgeIndex>           Frame;
+    typedef typename default_queue_policy<Weight>::type::template queue<Distance>::type Heap;
+
+    static_assert(is_dense_graph<GRAPH>::value,
+                  "TraversalWorkspace needs a dense graph like CompressedGraph");
+
+  public: // Colors; a node which has not been touched in this search is white
+    static constexpr Color White = 0;
+    static constexpr Color Grey  = 1;
+    static constexpr Color Black = 2;
+
+  public:
+    /// Constructor; allocates the arrays for all nodes of g
+    explicit TraversalWorkspace(const GRAPH& g)
+    : m_graph(&g), m_epoch(0), m_stamp(g.no_of_nodes(),0),
+      m_color(g.no_of_nodes(),White), m_distance(g.no_of_nodes()),
+      m_predecessor(g.no_of_nodes())
+    {}
+
+    /// The graph the workspace belongs to
+    const GRAPH& graph() const { return *m_graph; }
+
+    /// Starts a new search: forgets the state of all nodes in O(1)
+    void start()
+    {
+      if (++m_epoch == 0) {
+        // The epoch counter wrapped around (after 2^32 searches)
+        std::fill(m_stamp.begin(),m_stamp.end(),Epoch(0));
+        m_epoch = 1;
+      }
+      m_queue.clear();
+      m_stack.clear();
+      if (m_heap) m_heap->clear();
+    }
+
+    /// Has node v been touched in this search?
+    bool visited(NodeId v) const { return m_stamp[v] == m_epoch; }
+
+    /// Marks node v; returns false if it was marked before in this search
+    bool visit(NodeId v)
+    {
+      if (visited(v)) return false;
+      touch(v);
+      return true;
+    }
+
+    /// Color of node v
+    Color color(NodeId v) const { return visited(v) ? m_color[v] : White; }
+
+    /// Sets the color of node v
+    void set_color(NodeId v, Color c)
+    {
+      touch(v);
+      m_color[v] = c;
+    }
+
+    /// Distance of node v (only meaningful if visited(v))
+    const Distance& distance(NodeId v) const { return m_distance[v]; }
+
+    /// Sets the distance of node v
+    void set_distance(NodeId v, const Distance& d)
+    {
+      touch(v);
+      m_distance[v] = d;
+    }
+
+    /// Predecessor of node v on its shortest path (GRAPH::NoNode() for
+    /// the start node; only meaningful if visited(v))
+    NodeId predecessor(NodeId v) const { return m_predecessor[v]; }
+
+    /// Sets the predecessor of node v
+    void set_predecessor(NodeId v, NodeId u)
+    {
+      touch(v);
+      m_predecessor[v] = u;
+    }
+
+    /// Reusable buffers (cleared by start())
+    std::vector<NodeId>& queue()          { return m_queue; }
+    std::vector<Frame>&  stack()          { return m_stack; }
+    Heap& heap()
+    {
+      // Building the queue may scan all edge weights (see max_edge_weight)
+      if (!m_heap) m_heap.emplace(m_graph->no_of_nodes(),detail::max_edge_weight(*m_graph));
+      return *m_heap;
+    }
+
+  private:
+    /// Makes the state of v valid for this search
+    void touch(NodeId v)
+    {
+      if (m_stamp[v] != m_epoch) {
+        m_stamp[v] = m_epoch;
+        m_color[v] = White;
+        m_distance[v] = Distance();
+        m_predecessor[v] = GRAPH::NoNode();
+      }
+    }
+
+  private: // Member variables
+    const GRAPH*            m_graph;
+    Epoch                   m_epoch;       ///< Number of the current search
+    std::vector<Epoch>      m_stamp;       ///< Search which last touched each node
+    std::vector<Color>      m_color;       ///< Color of each node
+    std::vector<Distance>   m_distance;    ///< Distance of each node
+    std::vector<NodeId>     m_predecessor; ///< Predecessor of each node
+    std::vector<NodeId>     m_queue;       ///< BFS queue
+    std::vector<Frame>      m_stack;       ///< DFS stack
+    std::optional<Heap>     m_heap;        ///< Dijkstra queue, built on demand
+  }; // TraversalWorkspace
+
+} // namespace MyCoolGraphLibrary
+
+#endif
@@ -11,14 +11,15 @@
 
 namespace MyCoolGraphLibrary {
   
-  /// WeightedGraphEdge represents a weighted directed graph edge
-  template<typename NODE,typename LABEL>
+  /// WeightedGraphEdge represents a weighted directed graph edge.
+  /// WEIGHT is the type of the edge weights (unsigned int by default).
+  template<typename NODE,typename LABEL,typename WEIGHT = unsigned int>
   struct WeightedGraphEdge : public SimpleGraphEdge<NODE,LABEL>
   {
   public:
     typedef NODE    Node;
     typedef LABEL   Label;
-    typedef unsigned int Weight;
+    typedef WEIGHT  Weight;
 
     WeightedGraphEdge(const Node& s, const Label& l, const Node& t, const Weight& w)
     : SimpleGraphEdge<NODE,LABEL>(s, l, t), m_weight(w)
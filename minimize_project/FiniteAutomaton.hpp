@@ -9,7 +9,11 @@
 
 #include <vector>
 #include <unordered_set>
+#include <memory_resource>
+#include <functional>
 #include <iostream>
+#include <string>
+#include <charconv>
 #include <cassert>
 #include <limits>
 #include <cstdlib> // for abort()
@@ -17,20 +21,30 @@
 #include <boost/container/flat_map.hpp>
 
 /// FiniteAutomaton implements a simple finite state automaton
+/// All states and transitions are allocated from a memory resource
+/// (the default resource unless one is passed to the constructor)
 class FiniteAutomaton
 {
   public: // Types
     typedef int                                       State;
     typedef unsigned char                             Symbol;
-    typedef boost::container::flat_map<Symbol,State>  SymbolStateMap; 
+    typedef boost::container::flat_map<Symbol,State,std::less<Symbol>,
+              std::pmr::polymorphic_allocator<std::pair<Symbol,State> > > SymbolStateMap; 
 
   private: // Types
-    typedef std::unordered_set<State>     StateSet;
-    typedef std::vector<SymbolStateMap>   Delta;
+    typedef std::pmr::unordered_set<State>    StateSet;
+    typedef std::pmr::vector<SymbolStateMap>  Delta;
 
   public: // Static functions
     inline static State NoState() { return -1; }
  
+  public: // Constructor
+    /// Creates an empty FSA which allocates from r, e.g. a
+    /// std::pmr::monotonic_buffer_resource which releases everything at once
+    explicit FiniteAutomaton(std::pmr::memory_resource* r = std::pmr::get_default_resource())
+    : delta(r), free_states(r), final_states(r)
+    {}
+
   public: // Functions
     /// Returns the number of the final states in the FSA
     inline unsigned no_of_final_states() const
@@ -79,24 +93,39 @@ class FiniteAutomaton
     }
 
     /// Print a dot representation of the FSA to stream 'out'
+    /// The text is collected in a large buffer with std::to_chars for the
+    /// numbers and written in big blocks; the stream is flushed once.
     void print_dot(std::ostream& out) const
     {
-      out << "digraph FSM {" << std::endl;
-      out << "graph [rankdir=LR, fontsize=14, center=1, orientation=Portrait];" << std::endl;
-      out << "node  [font = \"Arial\", shape = circle, style=filled, fontcolor=black, color=lightgray]" << std::endl;
-      out << "edge  [fontname = \"Arial\"]" << std::endl << std::endl;
+      std::string buffer;
+      buffer.reserve(dot_buffer_size + 64);
+      buffer += "digraph FSM {\n"
+                "graph [rankdir=LR, fontsize=14, center=1, orientation=Portrait];\n"
+                "node  [font = \"Arial\", shape = circle, style=filled, fontcolor=black, color=lightgray]\n"
+                "edge  [fontname = \"Arial\"]\n\n";
 
       for (unsigned q = 0; q < delta.size(); ++q) {
-        out << q << " [label = \"" << q << "\"";
-        if (is_final(State(q)) == true) { out << ", shape=doublecircle]" << std::endl; }
-        else { out << "]" << std::endl; }
-        //out << (is_final(State(q)) ? ", shape=doublecircle]" << std::endl : "]" << std::endl);
+        append_number(buffer,q);
+        buffer += " [label = \"";
+        append_number(buffer,q);
+        buffer += is_final(State(q)) ? "\", shape=doublecircle]\n" : "\"]\n";
         const SymbolStateMap& q_tr = delta[q];
         for (auto t = q_tr.begin(); t != q_tr.end(); ++t) {
-          out << q << " -> " << t->second << " [label = \"" << t->first << "\"]" << std::endl;
+          append_number(buffer,q);
+          buffer += " -> ";
+          append_number(buffer,t->second);
+          buffer += " [label = \"";
+          buffer += char(t->first);
+          buffer += "\"]\n";
+        }
+        if (buffer.size() >= dot_buffer_size) {
+          out.write(buffer.data(),buffer.size());
+          buffer.clear();
         }
       }
-      out << "}" << std::endl;
+      buffer += "}\n";
+      out.write(buffer.data(),buffer.size());
+      out.flush();
     }
   
     /// Find target state p of the transition q --a-> p . 
@@ -159,7 +188,7 @@ class FiniteAutomaton
         return freeState;
       } else {
         if (delta.size() < delta.max_size()) {
-          delta.push_back(SymbolStateMap());
+          delta.emplace_back();
           return (delta.size()-1);
         } else {
           return NoState();
@@ -194,6 +223,18 @@ class FiniteAutomaton
       free_states.insert(q);
     }
   
+  private: // Functions
+    /// Size at which print_dot() writes its buffer to the stream
+    static const std::size_t dot_buffer_size = 1 << 16;
+
+    /// Appends the decimal representation of x to s
+    template<typename T>
+    static void append_number(std::string& s, T x)
+    {
+      char digits[24];
+      s.append(digits,std::to_chars(digits,digits + sizeof(digits),x).ptr);
+    }
+
   private:
     Delta delta;                   ///< Delta-function
     StateSet free_states;          ///< Free states